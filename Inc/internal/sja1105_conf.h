@@ -29,6 +29,12 @@ extern "C" {
 
 void SJA1105_ResetTables(sja1105_handle_t *dev, uint32_t fixed_length_table_buffer[SJA1105_FIXED_BUFFER_SIZE]);
 void SJA1105_ResetManagementRoutes(sja1105_handle_t *dev);
+void SJA1105_ResetTransaction(sja1105_handle_t *dev);
+void SJA1105_ResetScrubber(sja1105_handle_t *dev);
+void SJA1105_ResetStormControl(sja1105_handle_t *dev);
+void SJA1105_ResetPortSleep(sja1105_handle_t *dev);
+void SJA1105_ResetLinkMonitor(sja1105_handle_t *dev);
+void SJA1105_ResetTempMonitor(sja1105_handle_t *dev);
 void SJA1105_ResetEventCounters(sja1105_handle_t *dev);
 
 sja1105_status_t SJA1105_CheckPartID(sja1105_handle_t *dev);
@@ -36,19 +42,37 @@ sja1105_status_t SJA1105_CheckDeviceID(sja1105_handle_t *dev, uint32_t device_id
 
 sja1105_status_t SJA1105_ConfigureACU(sja1105_handle_t *dev, bool write);
 sja1105_status_t SJA1105_ConfigureACUPort(sja1105_handle_t *dev, uint8_t port_num, bool write);
+sja1105_status_t SJA1105_ACUReadPortStatus(sja1105_handle_t *dev, sja1105_port_status_t port_status[SJA1105_NUM_PORTS]);
 
 sja1105_status_t SJA1105_ConfigureCGU(sja1105_handle_t *dev, bool write);
 sja1105_status_t SJA1105_ConfigureCGUPort(sja1105_handle_t *dev, uint8_t port_num, bool write);
+sja1105_status_t SJA1105_CGUPortSetPowerDown(sja1105_handle_t *dev, uint8_t port_num, bool power_down);
 
+bool             SJA1105_SGMIIInUse(const sja1105_handle_t *dev);
+sja1105_status_t SJA1105_SGMIIRead(sja1105_handle_t *dev, uint32_t addr, uint16_t *value);
+sja1105_status_t SJA1105_SGMIIWrite(sja1105_handle_t *dev, uint32_t addr, uint16_t value);
+sja1105_status_t SJA1105_SGMIISetSpeed(sja1105_handle_t *dev, sja1105_speed_t speed);
+sja1105_status_t SJA1105_ConfigureSGMII(sja1105_handle_t *dev);
+
+sja1105_status_t SJA1105_LoadBlock(sja1105_handle_t *dev, const uint32_t *block, uint32_t block_size, bool borrow);
+sja1105_status_t SJA1105_LoadStaticConfigFinish(sja1105_handle_t *dev);
 sja1105_status_t SJA1105_LoadStaticConfig(sja1105_handle_t *dev, const uint32_t *static_conf, uint32_t static_conf_size);
 sja1105_status_t SJA1105_WriteStaticConfig(sja1105_handle_t *dev, bool safe);
+sja1105_status_t SJA1105_WriteLastBlock(sja1105_handle_t *dev, uint32_t offset, uint32_t global_crc);
 sja1105_status_t SJA1105_SyncStaticConfig(sja1105_handle_t *dev);
+sja1105_status_t SJA1105_FinishStaticConfigUpload(sja1105_handle_t *dev);
+uint32_t         SJA1105_StaticConfigSize(const sja1105_handle_t *dev);
+sja1105_status_t SJA1105_SerialiseStaticConfigToSink(sja1105_handle_t *dev, sja1105_callback_export_t sink, void *context, uint32_t *size);
+sja1105_status_t SJA1105_SerialiseStaticConfig(sja1105_handle_t *dev, uint32_t *image, uint32_t capacity, uint32_t *size);
 sja1105_status_t SJA1105_CheckRequiredTables(sja1105_handle_t *dev);
+sja1105_status_t SJA1105_CheckTableConsistency(sja1105_handle_t *dev);
 sja1105_status_t SJA1105_ReadStaticConfFlags(sja1105_handle_t *dev, uint32_t *flags);
 
 sja1105_status_t SJA1105_FreeAllTableMemory(sja1105_handle_t *dev);
-sja1105_status_t SJA1105_AllocateFixedLengthTable(sja1105_handle_t *dev, const uint32_t *block, uint8_t block_size);
-sja1105_status_t SJA1105_AllocateVariableLengthTable(sja1105_handle_t *dev, const uint32_t *block, uint8_t block_size);
+sja1105_status_t SJA1105_AllocateDirtyBitmap(sja1105_handle_t *dev, sja1105_table_t *table, uint8_t id);
+sja1105_status_t SJA1105_AllocateFixedLengthTable(sja1105_handle_t *dev, const uint32_t *block, uint32_t block_size);
+sja1105_status_t SJA1105_AllocateVariableLengthTable(sja1105_handle_t *dev, const uint32_t *block, uint32_t block_size, bool borrow);
+sja1105_status_t SJA1105_TableMakeWritable(sja1105_handle_t *dev, sja1105_table_t *table);
 
 
 #ifdef __cplusplus
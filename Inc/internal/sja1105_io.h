@@ -38,6 +38,30 @@ extern "C" {
 #define SJA1105_T_SPI_LEAD       (40)     /* ns */
 #define SJA1105_T_SPI_LAG        (40)     /* ns */
 
+/* Dynamic reconfiguration */
+#define SJA1105_DYN_CONF_MAX_BATCH               (16)                                                                        /* Maximum number of entries written back-to-back by a single call to SJA1105_DynConfWriteMultiple() */
+#define SJA1105_DYN_CONF_READ_BATCH              (4)                                                                         /* Number of entries read back-to-back into a temporary buffer by SJA1105_DynTableReadAll() */
+#define SJA1105_DYN_CONF_IS_CONTIGUOUS(dyn_conf) (((dyn_conf)->entry_addr + (dyn_conf)->entry_size) == (dyn_conf)->cmd_addr) /* Entry registers are directly followed by the command register, so both can be accessed in one transaction */
+
+
+/* Describes the registers used to dynamically reconfigure one table */
+typedef struct {
+    uint32_t entry_addr; /* Address of the first entry register */
+    uint32_t cmd_addr;   /* Address of the command register (register 0 in the user manual) */
+    uint8_t  entry_size; /* Number of entry registers */
+    uint32_t valid;      /* VALID flag in the command register */
+    uint32_t rdwrset;    /* RDWRSET flag in the command register */
+    uint32_t errors;     /* ERRORS flag in the command register, 0 if the table doesn't report errors */
+} sja1105_dyn_conf_t;
+
+extern const sja1105_dyn_conf_t SJA1105_DYN_CONF_L2_LUT_DESC;
+extern const sja1105_dyn_conf_t SJA1105_DYN_CONF_L2_FORWARDING_DESC;
+extern const sja1105_dyn_conf_t SJA1105_DYN_CONF_MAC_CONF_DESC;
+extern const sja1105_dyn_conf_t SJA1105_DYN_CONF_VLAN_LOOKUP_DESC;
+extern const sja1105_dyn_conf_t SJA1105_DYN_CONF_RETAGGING_DESC;
+extern const sja1105_dyn_conf_t SJA1105_DYN_CONF_GENERAL_PARAMS_DESC;
+extern const sja1105_dyn_conf_t SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_DESC;
+
 
 sja1105_status_t SJA1105_ReadRegister(sja1105_handle_t *dev, uint32_t addr, uint32_t *data, uint32_t size);
 sja1105_status_t SJA1105_ReadRegisterWithCheck(sja1105_handle_t *dev, uint32_t addr, uint32_t *data, uint32_t size);
@@ -46,6 +70,13 @@ sja1105_status_t SJA1105_WriteRegister(sja1105_handle_t *dev, uint32_t addr, con
 sja1105_status_t SJA1105_ReadFlag(sja1105_handle_t *dev, uint32_t addr, uint32_t mask, bool *result);
 sja1105_status_t SJA1105_PollFlag(sja1105_handle_t *dev, uint32_t addr, uint32_t mask, bool polarity);
 
+sja1105_status_t SJA1105_DynConfPoll(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, uint32_t *command, uint32_t *entry);
+sja1105_status_t SJA1105_DynConfCommand(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, uint32_t command, const uint32_t *entry);
+sja1105_status_t SJA1105_DynConfWrite(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, uint32_t command, const uint32_t *entry);
+sja1105_status_t SJA1105_DynConfRead(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, uint32_t command, const uint32_t *key, uint32_t *entry);
+sja1105_status_t SJA1105_DynConfWriteMultiple(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, const uint32_t *commands, const uint32_t *const *entries, uint32_t count);
+sja1105_status_t SJA1105_DynConfReadMultiple(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, const uint32_t *commands, const uint32_t *const *keys, uint32_t *const *entries, uint32_t *results, uint32_t count);
+
 sja1105_status_t SJA1105_WriteTable(sja1105_handle_t *dev, uint32_t addr, sja1105_table_t *table, bool safe);
 
 sja1105_status_t SJA1105_L2LUTInvalidateRange(sja1105_handle_t *dev, uint16_t low_i, uint16_t high_i);
@@ -58,12 +58,21 @@ enum SJA1105_DeviceID_Enum {
 #define SJA1105_CRCCHKG_SHIFT                      (28)                           /* Global CRC check */
 #define SJA1105_CRCCHKG_MASK                       (0x1 << SJA1105_CRCCHKG_SHIFT) /* Global CRC check */
 
-#define SJA1105_REGULAR_CHECK_ADDR                 (SJA1105_REG_VL_PART_STATUS)
+#define SJA1105_REGULAR_CHECK_ADDR                 (SJA1105_REG_STATIC_CONF_FLAGS)
 #define SJA1105_REGULAR_CHECK_SIZE                 (SJA1105_REG_GENERAL_STATUS_11 - SJA1105_REGULAR_CHECK_ADDR + 1)
+#define SJA1105_REGULAR_CHECK_INDEX(reg)           ((reg) - SJA1105_REGULAR_CHECK_ADDR)
+
+#define SJA1105_RAM_PARITY_MEMORIES(lower, upper)  (((uint64_t) (upper) << 32) | (lower)) /* Memory n is bit n of general status 10 (n < 32) or bit n - 32 of general status 11 */
 
 #define SJA1105_L2BUSYS_SHIFT                      (0)
 #define SJA1105_L2BUSYS_MASK                       (0x1 << SJA1105_L2BUSYS_SHIFT)
 
+#define SJA1105_HASHCONFS                          (1 << 0) /* In general status 3 */
+#define SJA1105_VLANIDHC_SHIFT                     (4)
+#define SJA1105_VLANIDHC_MASK                      (0xfff << SJA1105_VLANIDHC_SHIFT)
+#define SJA1105_MACADDL_SHIFT                      (16)
+#define SJA1105_MACADDL_MASK                       (0xffff << SJA1105_MACADDL_SHIFT) /* Lower 16 bits of the MAC address, the upper 32 bits are in the next register */
+
 #define SJA1105_VLPARTS                            (1 << 0)
 #define SJA1105_VLROUTES                           (1 << 1)
 #define SJA1105_VLPARIND_SHIFT                     (8)
@@ -81,9 +90,21 @@ enum SJA1105_DeviceID_Enum {
 
 #define SJA1105_HIGH_LEVEL_STATS_N_TXBYTE_L        (0x0)
 #define SJA1105_HIGH_LEVEL_STATS_N_TXBYTE_H        (0x1)
+#define SJA1105_HIGH_LEVEL_STATS_N_TXFRM_L         (0x2)
+#define SJA1105_HIGH_LEVEL_STATS_N_TXFRM_H         (0x3)
 #define SJA1105_HIGH_LEVEL_STATS_N_RXBYTE_L        (0x4)
 #define SJA1105_HIGH_LEVEL_STATS_N_RXBYTE_H        (0x5)
+#define SJA1105_HIGH_LEVEL_STATS_N_RXFRM_L         (0x6)
+#define SJA1105_HIGH_LEVEL_STATS_N_RXFRM_H         (0x7)
 #define SJA1105_HIGH_LEVEL_STATS_N_POLERR          (0x8)
+#define SJA1105_HIGH_LEVEL_STATS_N_CTPOLERR        (0x9)
+#define SJA1105_HIGH_LEVEL_STATS_N_VLNOTFOUND      (0xa)
+#define SJA1105_HIGH_LEVEL_STATS_N_CRCERR          (0xb)
+#define SJA1105_HIGH_LEVEL_STATS_N_SIZEERR         (0xc)
+#define SJA1105_HIGH_LEVEL_STATS_N_UNRELEASED      (0xd)
+#define SJA1105_HIGH_LEVEL_STATS_N_VLANERR         (0xe)
+#define SJA1105_HIGH_LEVEL_STATS_N_N664ERR         (0xf)
+#define SJA1105_HIGH_LEVEL_STATS_DROP_SIZE         (SJA1105_HIGH_LEVEL_STATS_SIZE - SJA1105_HIGH_LEVEL_STATS_N_POLERR) /* Drop counters are the last words of each port's block */
 
 /* ---------------------------------------------------------------------------- */
 /* Auxiliary Configuration Unit */
@@ -100,6 +121,7 @@ enum SJA1105_DeviceID_Enum {
 #define SJA1105_ACU_INITIAL_CFG_PAD_MIIX_RX           (0x02020212)
 #define SJA1105_ACU_INITIAL_CFG_PAD_MIIX_TX           (0x12121212)
 
+#define SJA1105_ACU_TABLE_TS_CONFIG_INDEX             (2)
 #define SJA1105_ACU_TABLE_PAD_MIIX_RX_INDEX(port_num) (11 + (2 * (SJA1105_NUM_PORTS - 1 - (port_num))))
 #define SJA1105_ACU_TABLE_PAD_MIIX_TX_INDEX(port_num) (12 + (2 * (SJA1105_NUM_PORTS - 1 - (port_num))))
 
@@ -121,6 +143,12 @@ enum SJA1105_ACUReg_Enum {
 
 #define SJA1105_ACU_REG_PORT_STATUS_MIIX(port_num) (SJA1105_ACU_REG_PORT_STATUS_MII0 + (port_num))
 
+#define SJA1105_ACU_PORT_STATUS_XMII_MODE_SHIFT    (0)
+#define SJA1105_ACU_PORT_STATUS_XMII_MODE_MASK     (0x3 << SJA1105_ACU_PORT_STATUS_XMII_MODE_SHIFT) /* Same encoding as sja1105_interface_t */
+#define SJA1105_ACU_PORT_STATUS_PHY_MODE           (1 << 2)
+#define SJA1105_ACU_PORT_STATUS_SPEED_SHIFT        (3)
+#define SJA1105_ACU_PORT_STATUS_SPEED_MASK         (0x3 << SJA1105_ACU_PORT_STATUS_SPEED_SHIFT) /* Same encoding as sja1105_speed_t */
+
 #define SJA1105_ACU_REG_TS_CONFIG                  (0x100a00)
 #define SJA1105_ACU_REG_TS_STATUS                  (0x100a01)
 #define SJA1105_ACU_REG_PROD_CFG                   (0x100bc0)
@@ -198,11 +226,12 @@ enum SJA1105_PartNR_Enum {
     PART_NR_SJA1105S  = 0x9a87
 };
 
-#define SJA1105_TS_PD             (1 << 6)
-#define SJA1105_TS_THRESHOLD_MASK (0x3f)
-#define SJA1105_TS_EXCEEDED       (1)
+#define SJA1105_TS_PD              (1 << 6)
+#define SJA1105_TS_THRESHOLD_MASK  (0x3f)
+#define SJA1105_TS_EXCEEDED        (1)
 
-#define SJA1105_TS_LUT_SIZE       (40)
+#define SJA1105_TS_LUT_SIZE        (40)
+#define SJA1105_TS_MAX_TRACK_STEPS (4) /* Maximum number of LUT entries SJA1105_TemperatureMonitorUpdate() moves per call */
 static const int16_t SJA1105_TS_LUT[SJA1105_TS_LUT_SIZE] = {
     INT16_MIN, -457, -417, -375, -330, -284, -235, -183,
     -114, -61, -21, 21, 65, 110, 157, 206,
@@ -300,6 +329,56 @@ enum SJA1105_CGUReg_Enum {
 #define SJA1105_RGU_COLD_RST         (1 << 2)
 #define SJA1105_RGU_POR_RST          (1 << 1)
 
+/* ---------------------------------------------------------------------------- */
+/* SGMII PCS */
+/* ---------------------------------------------------------------------------- */
+
+#define SJA1105_SGMII_PORT (4) /* Only the SJA1105R and SJA1105S have an SGMII port */
+
+/* Each 16-bit PCS register is in the lower half of a 32-bit register */
+enum SJA1105_SGMIIReg_Enum {
+    SJA1105_SGMII_REG_BASIC_CONTROL       = 0x1f0000,
+    SJA1105_SGMII_REG_BASIC_STATUS        = 0x1f0001,
+    SJA1105_SGMII_REG_DIGITAL_CONTROL_1   = 0x1f8000,
+    SJA1105_SGMII_REG_AUTONEG_CONTROL     = 0x1f8001,
+    SJA1105_SGMII_REG_AUTONEG_INTR_STATUS = 0x1f8002,
+    SJA1105_SGMII_REG_DIGITAL_CONTROL_2   = 0x1f80e1,
+};
+
+#define SJA1105_SGMII_REG_BASE                   (SJA1105_SGMII_REG_BASIC_CONTROL)
+#define SJA1105_SGMII_REG_MASK                   (0xffff)
+
+#define SJA1105_SGMII_BASIC_CONTROL_RESET        (1 << 15)
+#define SJA1105_SGMII_BASIC_CONTROL_SPEED_LSB    (1 << 13)
+#define SJA1105_SGMII_BASIC_CONTROL_AN_ENABLE    (1 << 12)
+#define SJA1105_SGMII_BASIC_CONTROL_POWER_DOWN   (1 << 11)
+#define SJA1105_SGMII_BASIC_CONTROL_AN_RESTART   (1 << 9)
+#define SJA1105_SGMII_BASIC_CONTROL_FULL_DUPLEX  (1 << 8)
+#define SJA1105_SGMII_BASIC_CONTROL_SPEED_MSB    (1 << 6)
+#define SJA1105_SGMII_BASIC_CONTROL_SPEED_1G     (SJA1105_SGMII_BASIC_CONTROL_SPEED_MSB)
+#define SJA1105_SGMII_BASIC_CONTROL_SPEED_100M   (SJA1105_SGMII_BASIC_CONTROL_SPEED_LSB)
+#define SJA1105_SGMII_BASIC_CONTROL_SPEED_10M    (0)
+
+#define SJA1105_SGMII_BASIC_STATUS_LINK          (1 << 2)
+
+#define SJA1105_SGMII_DIGITAL_CONTROL_1_EN_VSMMD1    (1 << 13) /* Enable the vendor specific registers */
+#define SJA1105_SGMII_DIGITAL_CONTROL_1_CLOCK_STOP   (1 << 10) /* Allow the PHY to stop the clock during low power idle */
+#define SJA1105_SGMII_DIGITAL_CONTROL_1_MAC_AUTO_SW  (1 << 9)  /* Adapt to the autonegotiated speed without software */
+#define SJA1105_SGMII_DIGITAL_CONTROL_1_INIT         (1 << 8)  /* Flush the internal FIFOs */
+
+#define SJA1105_SGMII_DIGITAL_CONTROL_2_TX_POL_INV_DISABLE (1 << 4)
+
+#define SJA1105_SGMII_AUTONEG_CONTROL_MODE_SGMII (0x2 << 1)
+
+#define SJA1105_SGMII_AUTONEG_STATUS_LINK        (1 << 4)
+#define SJA1105_SGMII_AUTONEG_STATUS_SPEED_SHIFT (2)
+#define SJA1105_SGMII_AUTONEG_STATUS_SPEED_MASK  (0x3 << SJA1105_SGMII_AUTONEG_STATUS_SPEED_SHIFT)
+#define SJA1105_SGMII_AUTONEG_STATUS_SPEED_10M   (0x0)
+#define SJA1105_SGMII_AUTONEG_STATUS_SPEED_100M  (0x1)
+#define SJA1105_SGMII_AUTONEG_STATUS_SPEED_1G    (0x2)
+#define SJA1105_SGMII_AUTONEG_STATUS_DUPLEX      (1 << 1)
+#define SJA1105_SGMII_AUTONEG_STATUS_COMPLETE    (1 << 0)
+
 /* ---------------------------------------------------------------------------- */
 /* Static Configuration */
 /* ---------------------------------------------------------------------------- */
@@ -374,16 +453,90 @@ typedef enum {
 #define SJA1105_STATIC_CONF_MAC_CONF_SPEED_SHIFT                (1) /* shifted up by 1 */
 #define SJA1105_STATIC_CONF_MAC_CONF_SPEED_MASK                 (0x3 << SJA1105_STATIC_CONF_MAC_CONF_SPEED_SHIFT)
 
+#define SJA1105_STATIC_CONF_MAC_CONF_EGR_MIRR                   (40) /* EGR_MIRR at bit 40 */
+#define SJA1105_STATIC_CONF_MAC_CONF_ING_MIRR                   (41) /* ING_MIRR at bit 41 */
+#define SJA1105_STATIC_CONF_MAC_CONF_QUEUE_ENABLED(i)           (104 + ((i) * 19)) /* ENABLED[i] at bit 104 + 19i */
+#define SJA1105_STATIC_CONF_MAC_CONF_QUEUE_BASE(i)              (105 + ((i) * 19)) /* BASE[i] in [113 + 19i:105 + 19i] */
+#define SJA1105_STATIC_CONF_MAC_CONF_QUEUE_TOP(i)               (114 + ((i) * 19)) /* TOP[i] in [122 + 19i:114 + 19i] */
+#define SJA1105_STATIC_CONF_MAC_CONF_QUEUE_WIDTH                (9)
+
 #define SJA1105_STATIC_CONF_GENERAL_PARAMS_SIZE                 (11)
 
 #define SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE            (2)
 #define SJA1105_STATIC_CONF_L2_FORWARDING_NUM_ENTRIES           (13)
 #define SJA1105_STATIC_CONF_L2_FORWARDING_SIZE                  (SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE * SJA1105_STATIC_CONF_L2_FORWARDING_NUM_ENTRIES)
 
+#define SJA1105_STATIC_CONF_L2_FORWARDING_VLAN_PMAP_SHIFT(prio) (25 + ((prio) * 3)) /* [27:25] for priority 0 up to [48:46] for priority 7, shifted within the 64-bit entry */
+#define SJA1105_STATIC_CONF_L2_FORWARDING_VLAN_PMAP_MASK        ((uint32_t) 0x7)
+#define SJA1105_STATIC_CONF_L2_FORWARDING_FL_DOMAIN_SHIFT       (17) /* [53:49] therefore in the 2nd word, shifted up by 17 */
+#define SJA1105_STATIC_CONF_L2_FORWARDING_FL_DOMAIN_MASK        ((uint32_t) 0x1f << SJA1105_STATIC_CONF_L2_FORWARDING_FL_DOMAIN_SHIFT)
+#define SJA1105_STATIC_CONF_L2_FORWARDING_REACH_PORT_SHIFT      (22) /* [58:54] therefore in the 2nd word, shifted up by 22 */
+#define SJA1105_STATIC_CONF_L2_FORWARDING_REACH_PORT_MASK       ((uint32_t) 0x1f << SJA1105_STATIC_CONF_L2_FORWARDING_REACH_PORT_SHIFT)
+#define SJA1105_STATIC_CONF_L2_FORWARDING_BC_DOMAIN_SHIFT       (27) /* [63:59] therefore in the 2nd word, shifted up by 27 */
+#define SJA1105_STATIC_CONF_L2_FORWARDING_BC_DOMAIN_MASK        ((uint32_t) 0x1f << SJA1105_STATIC_CONF_L2_FORWARDING_BC_DOMAIN_SHIFT)
+
 #define SJA1105_STATIC_CONF_L2_FORWARDING_PARAMS_SIZE           (3)
+#define SJA1105_STATIC_CONF_L2_FORWARDING_PARAMS_PART_SPC(i)    (13 + ((i) * 10)) /* PART_SPC[i] in [22 + 10i:13 + 10i] */
+#define SJA1105_STATIC_CONF_VL_FORWARDING_PARAMS_SIZE           (3)
+#define SJA1105_STATIC_CONF_VL_FORWARDING_PARAMS_PARTSPC(i)     (16 + ((i) * 10)) /* PARTSPC[i] in [25 + 10i:16 + 10i] */
+#define SJA1105_STATIC_CONF_PART_SPC_WIDTH                      (10)
+#define SJA1105_NUM_PARTITIONS                                  (8)
+#define SJA1105_FRAME_MEMORY_SIZE                               (929) /* Number of 128 byte frame buffers shared between the partitions */
+#define SJA1105_FRAME_MEMORY_RETAGGING_OVERHEAD                 (19)  /* Frame buffers reserved when the retagging table is in use */
 
 #define SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE              (2)
 
+#define SJA1105_STATIC_CONF_L2_POLICING_PARTITION_SHIFT         (12) /* [14:12] therefore in the 1st word, shifted up by 12 */
+#define SJA1105_STATIC_CONF_L2_POLICING_PARTITION_MASK          ((uint32_t) 0x7 << SJA1105_STATIC_CONF_L2_POLICING_PARTITION_SHIFT)
+#define SJA1105_STATIC_CONF_L2_POLICING_MAXLEN_SHIFT            (15) /* [25:15] therefore in the 1st word, shifted up by 15 */
+#define SJA1105_STATIC_CONF_L2_POLICING_MAXLEN_MASK             ((uint32_t) 0x7ff << SJA1105_STATIC_CONF_L2_POLICING_MAXLEN_SHIFT)
+#define SJA1105_STATIC_CONF_L2_POLICING_RATE_LOW_SHIFT          (26) /* [31:26] of the 1st word contain bits [5:0] of RATE */
+#define SJA1105_STATIC_CONF_L2_POLICING_RATE_LOW_MASK           ((uint32_t) 0x3f << SJA1105_STATIC_CONF_L2_POLICING_RATE_LOW_SHIFT)
+#define SJA1105_STATIC_CONF_L2_POLICING_RATE_HIGH_SHIFT         (0) /* [9:0] of the 2nd word contain bits [15:6] of RATE */
+#define SJA1105_STATIC_CONF_L2_POLICING_RATE_HIGH_MASK          ((uint32_t) 0x3ff << SJA1105_STATIC_CONF_L2_POLICING_RATE_HIGH_SHIFT)
+#define SJA1105_STATIC_CONF_L2_POLICING_SMAX_SHIFT              (10) /* [57:42] therefore in the 2nd word, shifted up by 10 */
+#define SJA1105_STATIC_CONF_L2_POLICING_SMAX_MASK               ((uint32_t) 0xffff << SJA1105_STATIC_CONF_L2_POLICING_SMAX_SHIFT)
+#define SJA1105_STATIC_CONF_L2_POLICING_SHARINDX_SHIFT          (26) /* [63:58] therefore in the 2nd word, shifted up by 26 */
+#define SJA1105_STATIC_CONF_L2_POLICING_SHARINDX_MASK           ((uint32_t) 0x3f << SJA1105_STATIC_CONF_L2_POLICING_SHARINDX_SHIFT)
+
+#define SJA1105_L2_POLICING_RATE_UNIT_BPS                       (15625) /* RATE is in units of 1/64 Mbps */
+#define SJA1105_L2_POLICING_RATE_MAX                            (0xffff)
+#define SJA1105_L2_POLICING_MAXLEN_MAX                          (0x7ff)
+
+#define SJA1105_STATIC_CONF_L2_LOOKUP_PARAMS_SIZE               (4)
+#define SJA1105_STATIC_CONF_L2_LOOKUP_PARAMS_MAXADDRP(i)        (58 + ((i) * 11)) /* MAXADDRP[i] in [68 + 11i:58 + 11i] */
+#define SJA1105_STATIC_CONF_L2_LOOKUP_PARAMS_MAXADDRP_WIDTH     (11)
+
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE              (2)
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_GET(entry)       ((((entry)[0] >> 27) & 0x1f) | (((entry)[1] & 0x7f) << 5)) /* [38:27] */
+
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_LOW_SHIFT        (27) /* [31:27] of the VLAN ID in bits [4:0] of the 1st word */
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_LOW_MASK         ((uint32_t) 0x1f << SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_LOW_SHIFT)
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_HIGH_SHIFT       (0) /* [38:32] of the VLAN ID in bits [11:5] of the 2nd word */
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_HIGH_MASK        ((uint32_t) 0x7f << SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_HIGH_SHIFT)
+
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_TAG_PORT_SHIFT          (7) /* [43:39] therefore in the 2nd word, shifted up by 7 */
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_TAG_PORT_MASK           ((uint32_t) 0x1f << SJA1105_STATIC_CONF_VLAN_LOOKUP_TAG_PORT_SHIFT)
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VLAN_BC_SHIFT           (12) /* [48:44] therefore in the 2nd word, shifted up by 12 */
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VLAN_BC_MASK            ((uint32_t) 0x1f << SJA1105_STATIC_CONF_VLAN_LOOKUP_VLAN_BC_SHIFT)
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VMEMB_PORT_SHIFT        (17) /* [53:49] therefore in the 2nd word, shifted up by 17 */
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VMEMB_PORT_MASK         ((uint32_t) 0x1f << SJA1105_STATIC_CONF_VLAN_LOOKUP_VMEMB_PORT_SHIFT)
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VEGR_MIRR_SHIFT         (22) /* [58:54] therefore in the 2nd word, shifted up by 22 */
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VEGR_MIRR_MASK          ((uint32_t) 0x1f << SJA1105_STATIC_CONF_VLAN_LOOKUP_VEGR_MIRR_SHIFT)
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VING_MIRR_SHIFT         (27) /* [63:59] therefore in the 2nd word, shifted up by 27 */
+#define SJA1105_STATIC_CONF_VLAN_LOOKUP_VING_MIRR_MASK          ((uint32_t) 0x1f << SJA1105_STATIC_CONF_VLAN_LOOKUP_VING_MIRR_SHIFT)
+
+#define SJA1105_STATIC_CONF_RETAGGING_ENTRY_SIZE                (2)
+#define SJA1105_STATIC_CONF_RETAGGING_EGR_PORT                  (59) /* EGR_PORT in [63:59] */
+#define SJA1105_STATIC_CONF_RETAGGING_INGR_PORT                 (54) /* INGR_PORT in [58:54] */
+#define SJA1105_STATIC_CONF_RETAGGING_USE_DEST_PORTS            (28) /* USE_DEST_PORTS at bit 28 */
+#define SJA1105_STATIC_CONF_RETAGGING_DESTPORTS                 (23) /* DESTPORTS in [27:23] */
+
+#define SJA1105_STATIC_CONF_CBS_ENTRY_SIZE                      (5)
+#define SJA1105_STATIC_CONF_CBS_PORT                            (157) /* PORT in [159:157] */
+#define SJA1105_STATIC_CONF_CBS_PRIO                            (154) /* PRIO in [156:154] */
+#define SJA1105_STATIC_CONF_CBS_FIELD_WIDTH                     (3)
+
 #define SJA1105_MAC_FLT_START_OFFSET_W                          (4) /* Starts at bit 152 therefore in the 5th word */
 #define SJA1105_MAC_FLT_START_OFFSET_B                          (3) /* Starts at bit 152 therefore offset 3 bytes from the nearest multiple of 32 bits (128 + 3 * 8 = 152) */
 
@@ -396,6 +549,10 @@ typedef enum {
 #define SJA1105_STATIC_CONF_GENERAL_PARAMS_HOST_PORT_SHIFT      (14) /* shifted up by 14 */
 #define SJA1105_STATIC_CONF_GENERAL_PARAMS_HOST_PORT_MASK       (0x7 << SJA1105_STATIC_CONF_GENERAL_PARAMS_HOST_PORT_SHIFT)
 
+#define SJA1105_STATIC_CONF_GENERAL_PARAMS_MIRR_PORT_OFFSET     (4)  /* [141:139] therefore in the 5th word */
+#define SJA1105_STATIC_CONF_GENERAL_PARAMS_MIRR_PORT_SHIFT      (11) /* shifted up by 11 */
+#define SJA1105_STATIC_CONF_GENERAL_PARAMS_MIRR_PORT_MASK       (0x7 << SJA1105_STATIC_CONF_GENERAL_PARAMS_MIRR_PORT_SHIFT)
+
 #define SJA1105_STATIC_CONF_XMII_MODE_SIZE                      (1)
 
 #define SJA1105_STATIC_CONF_XMII_MODE_PHY_MAC_SHIFT(port_num)   (19 + ((port_num) * 3))
@@ -410,24 +567,36 @@ typedef enum {
 
 
 enum SJA1105_DynConfReg_Enum {
-    SJA1105_DYN_CONF_L2_LUT_REG_0        = 0x29,
-    SJA1105_DYN_CONF_L2_LUT_REG_1        = 0x24,
-    SJA1105_DYN_CONF_L2_LUT_REG_2        = 0x25,
-    SJA1105_DYN_CONF_L2_LUT_REG_3        = 0x26,
-    SJA1105_DYN_CONF_L2_LUT_REG_4        = 0x27,
-    SJA1105_DYN_CONF_L2_LUT_REG_5        = 0x28,
-    SJA1105_DYN_CONF_L2_FORWARDING_REG_0 = 0x2c,
-    SJA1105_DYN_CONF_L2_FORWARDING_REG_1 = 0x2a,
-    SJA1105_DYN_CONF_L2_FORWARDING_REG_2 = 0x2b,
-    SJA1105_DYN_CONF_MAC_CONF_REG_0      = 0x53,
-    SJA1105_DYN_CONF_MAC_CONF_REG_1      = 0x4b,
-    SJA1105_DYN_CONF_MAC_CONF_REG_2      = 0x4c,
-    SJA1105_DYN_CONF_MAC_CONF_REG_3      = 0x4d,
-    SJA1105_DYN_CONF_MAC_CONF_REG_4      = 0x4e,
-    SJA1105_DYN_CONF_MAC_CONF_REG_5      = 0x4f,
-    SJA1105_DYN_CONF_MAC_CONF_REG_6      = 0x50,
-    SJA1105_DYN_CONF_MAC_CONF_REG_7      = 0x51,
-    SJA1105_DYN_CONF_MAC_CONF_REG_8      = 0x52,
+    SJA1105_DYN_CONF_L2_LUT_REG_0            = 0x29,
+    SJA1105_DYN_CONF_L2_LUT_REG_1            = 0x24,
+    SJA1105_DYN_CONF_L2_LUT_REG_2            = 0x25,
+    SJA1105_DYN_CONF_L2_LUT_REG_3            = 0x26,
+    SJA1105_DYN_CONF_L2_LUT_REG_4            = 0x27,
+    SJA1105_DYN_CONF_L2_LUT_REG_5            = 0x28,
+    SJA1105_DYN_CONF_L2_FORWARDING_REG_0     = 0x2c,
+    SJA1105_DYN_CONF_L2_FORWARDING_REG_1     = 0x2a,
+    SJA1105_DYN_CONF_L2_FORWARDING_REG_2     = 0x2b,
+    SJA1105_DYN_CONF_VLAN_LOOKUP_REG_0       = 0x30, /* Register 0x2f is unused */
+    SJA1105_DYN_CONF_VLAN_LOOKUP_REG_1       = 0x2d,
+    SJA1105_DYN_CONF_VLAN_LOOKUP_REG_2       = 0x2e,
+    SJA1105_DYN_CONF_RETAGGING_REG_0         = 0x3a,
+    SJA1105_DYN_CONF_RETAGGING_REG_1         = 0x38,
+    SJA1105_DYN_CONF_RETAGGING_REG_2         = 0x39,
+    SJA1105_DYN_CONF_GENERAL_PARAMS_REG_0    = 0x46,
+    SJA1105_DYN_CONF_GENERAL_PARAMS_REG_1    = 0x3b,
+    SJA1105_DYN_CONF_GENERAL_PARAMS_REG_11   = 0x45,
+    SJA1105_DYN_CONF_MAC_CONF_REG_0          = 0x53,
+    SJA1105_DYN_CONF_MAC_CONF_REG_1          = 0x4b,
+    SJA1105_DYN_CONF_MAC_CONF_REG_2          = 0x4c,
+    SJA1105_DYN_CONF_MAC_CONF_REG_3          = 0x4d,
+    SJA1105_DYN_CONF_MAC_CONF_REG_4          = 0x4e,
+    SJA1105_DYN_CONF_MAC_CONF_REG_5          = 0x4f,
+    SJA1105_DYN_CONF_MAC_CONF_REG_6          = 0x50,
+    SJA1105_DYN_CONF_MAC_CONF_REG_7          = 0x51,
+    SJA1105_DYN_CONF_MAC_CONF_REG_8          = 0x52,
+    SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_REG_0  = 0x58,
+    SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_REG_1  = 0x54,
+    SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_REG_4  = 0x57,
 };
 
 #define SJA1105_DYN_CONF_L2_LUT_VALID     (1 << 31)
@@ -470,6 +639,8 @@ enum SJA1105_L2LUTHostCmd_Enum {
 
 #define SJA1105_MGMT_L2ADDR_LU_ENTRY_SIZE          (3)
 
+#define SJA1105_DYN_CONF_MAX_ENTRY_SIZE            (SJA1105_STATIC_CONF_GENERAL_PARAMS_SIZE) /* Largest number of entry registers of any dynamic reconfiguration interface */
+
 #define SJA1105_DYN_CONF_VALID                     (1 << 31)
 #define SJA1105_DYN_CONF_ERRORS                    (1 << 30)
 #define SJA1105_DYN_CONF_RDWRSET                   (1 << 29)
@@ -480,6 +651,24 @@ enum SJA1105_L2LUTHostCmd_Enum {
 #define SJA1105_DYN_CONF_MAC_CONF_PORTID_SHIFT     (0)
 #define SJA1105_DYN_CONF_MAC_CONF_PORTID_MASK      (0x7 << SJA1105_DYN_CONF_MAC_CONF_PORTID_SHIFT)
 
+#define SJA1105_DYN_CONF_VLAN_LOOKUP_VALID         (1 << 31)
+#define SJA1105_DYN_CONF_VLAN_LOOKUP_RDWRSET       (1 << 30)
+#define SJA1105_DYN_CONF_VLAN_LOOKUP_VALIDENT      (1 << 27) /* Set when writing to add the entry, cleared to remove it. After a read it shows whether the entry exists */
+
+#define SJA1105_DYN_CONF_RETAGGING_VALID           (1 << 31)
+#define SJA1105_DYN_CONF_RETAGGING_ERRORS          (1 << 30)
+#define SJA1105_DYN_CONF_RETAGGING_VALIDENT        (1 << 29)
+#define SJA1105_DYN_CONF_RETAGGING_RDWRSET         (1 << 28)
+#define SJA1105_DYN_CONF_RETAGGING_INDEX_SHIFT     (0)
+#define SJA1105_DYN_CONF_RETAGGING_INDEX_MASK      (0x3f << SJA1105_DYN_CONF_RETAGGING_INDEX_SHIFT)
+
+#define SJA1105_DYN_CONF_GENERAL_PARAMS_VALID      (1 << 31)
+#define SJA1105_DYN_CONF_GENERAL_PARAMS_ERRORS     (1 << 30)
+#define SJA1105_DYN_CONF_GENERAL_PARAMS_RDWRSET    (1 << 28)
+
+#define SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_VALID    (1 << 31)
+#define SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_RDWRSET  (1 << 30)
+
 
 #ifdef __cplusplus
 }
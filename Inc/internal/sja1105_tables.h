@@ -15,6 +15,7 @@ extern "C" {
 
 #include "sja1105.h"
 #include "internal/sja1105_regs.h"
+#include "internal/sja1105_io.h"
 
 
 #define SJA1105_GET_TABLE_LENGTH_TYPE(id)                \
@@ -44,15 +45,37 @@ extern "C" {
         __table_index;                                     \
     })
 
+#define SJA1105_GET_TABLE_MAX_ENTRIES(id) (((id) > SJA1105_BLOCK_ID_SGMII_CONF) ? 0 : SJA1105_TABLE_MAX_ENTRIES_LUT[(id)])
+#define SJA1105_GET_TABLE_ENTRY_SIZE(id)  (((id) > SJA1105_BLOCK_ID_SGMII_CONF) ? 0 : SJA1105_TABLE_ENTRY_SIZE_LUT[(id)])
+#define SJA1105_DIRTY_BITMAP_SIZE(id)     ((SJA1105_GET_TABLE_MAX_ENTRIES(id) + 31) / 32) /* Number of uint32_t in a table's dirty bitmap */
+#define SJA1105_DYN_TABLE_NUM_READABLE    (7)                                              /* Number of tables in SJA1105_DYN_TABLE_READ_ORDER */
+#define SJA1105_VLAN_PRESENT_SIZE         ((SJA1105_NUM_VLAN_IDS + 31) / 32)                /* Number of uint32_t in the VLAN ID presence bitmap */
+#define SJA1105_VLAN_INDEX_SIZE           (SJA1105_NUM_VLAN_IDS / 2)                        /* Number of uint32_t needed to store a uint16_t position for every VLAN ID */
+
 
 extern const sja1105_table_type_t SJA1105_TABLE_TYPE_LUT[SJA1105_BLOCK_ID_SGMII_CONF + 1];
 extern const uint8_t              SJA1105_TABLE_INDEX_LUT[SJA1105_BLOCK_ID_SGMII_CONF + 1];
-
+extern const uint16_t             SJA1105_TABLE_MAX_ENTRIES_LUT[SJA1105_BLOCK_ID_SGMII_CONF + 1];
+extern const uint8_t              SJA1105_TABLE_ENTRY_SIZE_LUT[SJA1105_BLOCK_ID_SGMII_CONF + 1];
+extern const uint8_t              SJA1105_DYN_TABLE_READ_ORDER[SJA1105_DYN_TABLE_NUM_READABLE];
+extern const uint64_t             SJA1105_RAM_PARITY_MEMORY_LUT[SJA1105_BLOCK_ID_SGMII_CONF + 1];
+
+sja1105_table_t *SJA1105_GetTable(sja1105_handle_t *dev, uint8_t block_id);
+sja1105_status_t SJA1105_TableSetSize(sja1105_handle_t *dev, sja1105_table_t *table, uint32_t size);
+void             SJA1105_TableMarkDirty(sja1105_table_t *table, uint16_t index);
+void             SJA1105_TableSetWord(sja1105_table_t *table, uint32_t index, uint32_t value);
+void             SJA1105_TableMarkClean(sja1105_table_t *table, uint16_t index);
+void             SJA1105_TableMarkAllClean(sja1105_table_t *table);
+bool             SJA1105_TableIsDirty(const sja1105_table_t *table, uint16_t index);
+uint32_t         SJA1105_TableCountDirtyEntries(const sja1105_table_t *table);
+
+uint32_t         SJA1105_TableGetField(const uint32_t *data, uint_fast16_t low, uint_fast8_t width);
 sja1105_status_t SJA1105_CheckTable(sja1105_handle_t *dev, sja1105_block_id_t id, const uint32_t *table_data, uint32_t size);
 
 sja1105_status_t SJA1105_MACConfTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table);
 sja1105_status_t SJA1105_ResetMACConfTable(sja1105_handle_t *dev, bool write);
 sja1105_status_t SJA1105_MACConfTableWrite(sja1105_handle_t *dev, uint8_t port_num);
+sja1105_status_t SJA1105_MACConfTableWriteMultiple(sja1105_handle_t *dev, uint8_t port_mask);
 sja1105_status_t SJA1105_MACConfTableRead(sja1105_handle_t *dev, uint8_t port_num);
 sja1105_status_t SJA1105_MACConfTableGetSpeed(const sja1105_table_t *table, uint8_t port_num, sja1105_speed_t *speed);
 sja1105_status_t SJA1105_MACConfTableSetSpeed(sja1105_table_t *table, uint8_t port_num, sja1105_speed_t speed);
@@ -64,12 +87,40 @@ sja1105_status_t SJA1105_MACConfTableGetDynLearn(const sja1105_table_t *table, u
 sja1105_status_t SJA1105_MACConfTableSetDynLearn(sja1105_table_t *table, uint8_t port_num, bool dyn_learn);
 
 sja1105_status_t SJA1105_L2ForwardingTableRead(sja1105_handle_t *dev, uint8_t index);
+void             SJA1105_L2ForwardingEntryUnpack(const uint32_t entry[SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE], sja1105_l2_forwarding_t *forwarding);
+void             SJA1105_L2ForwardingEntryPack(const sja1105_l2_forwarding_t *forwarding, uint32_t entry[SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE]);
+
+void             SJA1105_PolicerEntryUnpack(const uint32_t entry[SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE], sja1105_policer_t *policer);
+void             SJA1105_PolicerEntryPack(const sja1105_policer_t *policer, uint32_t entry[SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE]);
+
+void             SJA1105_VLANEntryPack(const sja1105_vlan_t *vlan, uint32_t entry[SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE]);
+void             SJA1105_VLANEntryUnpack(const uint32_t entry[SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE], sja1105_vlan_t *vlan);
+sja1105_status_t SJA1105_VLANIndexBuild(sja1105_handle_t *dev);
+sja1105_status_t SJA1105_VLANIndexFree(sja1105_handle_t *dev);
+bool             SJA1105_VLANIsPresent(const sja1105_handle_t *dev, uint16_t vid);
+uint32_t        *SJA1105_VLANGetEntry(sja1105_handle_t *dev, uint16_t vid);
+sja1105_status_t SJA1105_VLANTableReserve(sja1105_handle_t *dev, uint16_t num_new);
+sja1105_status_t SJA1105_VLANTableAppend(sja1105_handle_t *dev, const uint32_t entry[SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE]);
+sja1105_status_t SJA1105_VLANTableRemove(sja1105_handle_t *dev, uint16_t vid);
 
 sja1105_status_t SJA1105_GeneralParamsTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table);
 sja1105_status_t SJA1105_GetMACFilters(sja1105_handle_t *dev, sja1105_mac_filters_t *mac_filters);
 
 sja1105_status_t SJA1105_xMIIModeTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table);
 
+sja1105_status_t SJA1105_L2PolicingTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table);
+sja1105_status_t SJA1105_L2LookupParamsTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table);
+sja1105_status_t SJA1105_RetaggingTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table);
+sja1105_status_t SJA1105_CBSTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table);
+
+bool             SJA1105_DynTableIsWritable(uint8_t block_id);
+sja1105_status_t SJA1105_DynTableReadRange(sja1105_handle_t *dev, uint8_t block_id, uint32_t first, uint32_t count, bool scrub, uint32_t *num_entries);
+sja1105_status_t SJA1105_DynTableGetEntry(sja1105_handle_t *dev, uint8_t block_id, uint16_t index, const sja1105_dyn_conf_t **dyn_conf, uint32_t **entry, uint32_t *command);
+sja1105_status_t SJA1105_TransactionGetEntry(sja1105_handle_t *dev, uint8_t block_id, uint16_t index, uint32_t **entry, uint8_t *entry_size);
+sja1105_status_t SJA1105_TransactionJournal(sja1105_handle_t *dev, uint8_t block_id, uint16_t index);
+void             SJA1105_TransactionRestore(sja1105_handle_t *dev);
+sja1105_status_t SJA1105_DynTableWriteEntries(sja1105_handle_t *dev, uint8_t block_id, const uint16_t *indices, uint32_t count);
+
 #ifdef __cplusplus
 }
 #endif
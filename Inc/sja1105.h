@@ -35,11 +35,32 @@ extern "C" {
 #define SJA1105_MAX_ATTEMPTS          (10)  /* Maximum number of attempts to try anything. E.g. polling a flag with timeout = 100ms will result in 10 reads 10ms apart. Must be > 0 */
 #define SJA1105_L2ADDR_LU_ENTRY_SIZE  (5)
 #define SJA1105_L2ADDR_LU_NUM_ENTRIES (1024)
+#define SJA1105_NUM_VLAN_IDS          (4096)
+#define SJA1105_NUM_POLICERS          (45)
+#define SJA1105_NUM_PRIORITIES        (8)
+#define SJA1105_CRC32_INIT            (0xffffffff) /* Initial state for SJA1105_CRC32Update(), the CRC is the bitwise inverse of the state */
+#define SJA1105_RLE_ZEROS             (0x80000000) /* Compressed image control word flag, the run is count zero words. Otherwise count words follow as they are */
+#define SJA1105_RLE_RESERVED          (0x40000000) /* Compressed image control word bit that must be 0 */
+#define SJA1105_RLE_COUNT_MASK        (0x3fffffff) /* Number of words in the run of a compressed image control word */
+#define SJA1105_RLE_MIN_ZEROS         (3)          /* Shortest run of zeros SJA1105_ImageCompress() encodes as a zero run */
+
+#define SJA1105_POLICER_INDEX(port_num, priority) (((port_num) * SJA1105_NUM_PRIORITIES) + (priority))     /* L2 policing entry used for frames received on a port with a given priority */
+#define SJA1105_POLICER_BC_INDEX(port_num)        ((SJA1105_NUM_PORTS * SJA1105_NUM_PRIORITIES) + (port_num)) /* L2 policing entry used for broadcast frames received on a port */
 
 #ifndef SJA1105_PORTS_START_ENABLED
 #define SJA1105_PORTS_START_ENABLED
 #endif
 
+#ifndef SJA1105_TRANSACTION_MAX_ENTRIES
+#define SJA1105_TRANSACTION_MAX_ENTRIES (16) /* Maximum number of table entries that can be changed in one transaction */
+#endif
+
+#define SJA1105_TRANSACTION_MAX_ENTRY_SIZE (8) /* Size of the largest entry that can be changed in a transaction */
+
+#ifndef SJA1105_VLAN_LOOKUP_HEADROOM
+#define SJA1105_VLAN_LOOKUP_HEADROOM (32) /* Number of spare entries allocated after the VLAN lookup table so VLANs can be added without moving it. Set to SJA1105_NUM_VLAN_IDS to never move it */
+#endif
+
 #define SJA1105_SPEED_MBPS_TO_ENUM(mbps) (((mbps) == 10) ? SJA1105_SPEED_10M : (((mbps) == 100) ? SJA1105_SPEED_100M : (((mbps) == 1000) ? SJA1105_SPEED_1G : SJA1105_SPEED_INVALID)))
 
 
@@ -60,7 +81,7 @@ typedef enum {
     SJA1105_STATIC_CONF_ERROR,
     SJA1105_MISSING_TABLE_ERROR,    /* A required table or a dependancy for a loaded table is missing */
     SJA1105_CRC_ERROR,              /* CRC Error detected in a static configuration, either by the driver or by the chip */
-    SJA1105_RAM_PARITY_ERROR,       /* RAM Parity error detected in one of the chip's memories, must be immediately reset */
+    SJA1105_RAM_PARITY_ERROR,       /* RAM Parity error detected in one of the chip's memories, must be immediately repaired with SJA1105_ParityRecover() or reset */
     SJA1105_NOT_IMPLEMENTED_ERROR,
     SJA1105_MUTEX_ERROR,            /* Serious mutex error, will normally just return SJA1105_BUSY if it tries to take a mutex held by another thread */
     SJA1105_DYNAMIC_MEMORY_ERROR,   /* Attempted to re-allocate without free, or free after free */
@@ -136,6 +157,8 @@ typedef struct {
     uint8_t            host_port;
     bool               skew_clocks;  /* Make xMII clocks use different phases (where possible) to improve EMC performance */
     uint8_t            switch_id;    /* Used to identify the switch that trapped a frame */
+    bool               trust_crcs;   /* Use the CRCs in the static config without checking them, so loading and uploading it needs no CRC calculations. Only set this for images made by SJA1105_ImageBuild() */
+    bool               zero_copy;    /* Variable length tables point into the static config (e.g. in flash) instead of being copied to RAM, and are only copied when first changed. The static config must stay valid until it is replaced */
 } sja1105_config_t;
 
 typedef struct {
@@ -146,6 +169,9 @@ typedef struct {
     uint32_t *data;           /* Array of uint32_t */
     uint32_t *data_crc;       /* CRC of data */
     bool      data_crc_valid; /* When the data is changed the CRC doesn't have to be recalculated immediately (to prevent recalculation multiple times e.g. when configuring multiple ports at the same time). Instead this flag can be set and the CRC will be calulated prior to writing */
+    uint32_t *dirty;          /* Bitmap with one bit per entry, set when an entry has been changed but not yet written to the device. The VLAN lookup table is indexed by VLAN ID */
+    uint32_t  capacity;       /* Number of uint32_t allocated for data. Variable length tables may have spare space after their entries so entries can be added without moving them */
+    bool      borrowed;       /* Set when data points into the caller's static config, which must not be written. Use SJA1105_TableMakeWritable() before changing the table */
 } sja1105_table_t;
 
 typedef enum {
@@ -189,11 +215,67 @@ typedef struct {
         uint32_t *device_id; /* Also the pointer to the start of the fixed length portion of the generic loader structure */
         uint32_t *fixed_length_buffer;
     };
-    uint32_t *first_free; /* Starts at device_id + 1. Every time a table is added it is moved to the first pointer after the table */
+    uint32_t *first_free;   /* Starts at device_id + 1. Every time a table is added it is moved to the first pointer after the table */
     uint32_t  global_crc;
     bool      global_crc_valid;
+    uint32_t *vlan_present; /* Bitmap with one bit per VLAN ID, set when the VLAN lookup table has an entry for it */
+    uint16_t *vlan_index;   /* Position of each VLAN ID's entry in the VLAN lookup table, only valid when its bit in vlan_present is set */
 } sja1105_tables_t;
 
+/* An entry of the L2 policing table */
+typedef struct {
+    uint32_t rate_bps; /* Rate limit in bits per second, rounded down to a multiple of 15.625 kbps. At most 1023.98 Mbps */
+    uint16_t burst;    /* Maximum burst size in bytes */
+    uint16_t max_len;  /* Longer frames are dropped. At most 2047 bytes */
+    uint8_t  sharindx; /* Index of the policer whose rate and burst are used. Set to the policer's own index to not share */
+} sja1105_policer_t;
+
+/* An entry of the L2 forwarding table for frames received on a port. Each port mask has bit n set for port n */
+typedef struct {
+    uint8_t reach_port;                        /* Ports that frames received on this port may be forwarded to */
+    uint8_t bc_domain;                         /* Ports that broadcasts received on this port are sent to */
+    uint8_t fl_domain;                         /* Ports that frames with an unknown destination received on this port are flooded to */
+    uint8_t vlan_pmap[SJA1105_NUM_PRIORITIES]; /* Priority, and therefore egress queue, of frames received with each VLAN PCP */
+} sja1105_l2_forwarding_t;
+
+/* An entry of the VLAN lookup table. Each port mask has bit n set for port n */
+typedef struct {
+    uint16_t vid;        /* VLAN ID */
+    uint8_t  ving_mirr;  /* Ports whose ingress traffic in this VLAN is mirrored */
+    uint8_t  vegr_mirr;  /* Ports whose egress traffic in this VLAN is mirrored */
+    uint8_t  vmemb_port; /* Ports that are members of this VLAN */
+    uint8_t  vlan_bc;    /* Ports that broadcasts in this VLAN are sent to */
+    uint8_t  tag_port;   /* Ports that send frames in this VLAN with a tag */
+} sja1105_vlan_t;
+
+typedef void (*sja1105_callback_storm_t)(sja1105_handle_t *dev, uint8_t port_num, bool active, uint32_t rate_fps, void *context);
+
+/* Storm control settings for a port. A storm starts when the rate of frames dropped by the port's policers reaches trigger_fps
+ * and ends once the rate has stayed below release_fps for hold_ms. The policers themselves limit the storm, so set the port's
+ * broadcast policer (see SJA1105_POLICER_BC_INDEX()) to the rate broadcasts should be limited to.
+ */
+typedef struct {
+    bool                     enabled;
+    uint32_t                 trigger_fps; /* Policed frames per second that start a storm */
+    uint32_t                 release_fps; /* Policed frames per second the rate must stay below to end a storm. At most trigger_fps */
+    uint32_t                 hold_ms;     /* Time the rate must stay below release_fps before the storm ends */
+    sja1105_callback_storm_t callback;    /* Called from SJA1105_StormControlUpdate() with the mutex held when a storm starts or ends. NULL = no callback */
+    void                    *context;     /* Passed to callback */
+} sja1105_storm_control_config_t;
+
+/* Storm control state of a port */
+typedef struct {
+    sja1105_storm_control_config_t config;
+    bool                           active;      /* true = a storm was detected and hasn't ended */
+    bool                           sampled;     /* true = last_drops and last_time hold a previous sample */
+    bool                           quiet;       /* true = the rate has been below release_fps since quiet_since */
+    uint32_t                       last_drops;  /* Policing drop counter at the previous sample */
+    uint32_t                       last_time;   /* Time of the previous sample */
+    uint32_t                       quiet_since; /* Time the rate dropped below release_fps during a storm */
+    uint32_t                       rate_fps;    /* Policed frame rate measured at the last sample */
+    uint32_t                       storms;      /* Number of storms detected on this port */
+} sja1105_storm_control_t;
+
 typedef struct {
     uint8_t mac_fltres0[MAC_ADDR_SIZE];
     uint8_t mac_flt0[MAC_ADDR_SIZE];
@@ -205,12 +287,40 @@ typedef struct {
     bool    incl_srcpt1;
 } sja1105_mac_filters_t;
 
+/* Changes to the MAC configuration of a group of ports. A field is only changed if its set_ flag is true */
+typedef struct {
+    bool set_ingress;
+    bool ingress;
+    bool set_egress;
+    bool egress;
+    bool set_dyn_learn;
+    bool dyn_learn;
+} sja1105_port_changes_t;
+
 /* Stores information about driver events */
 typedef struct {
     uint32_t static_conf_uploads;
     uint32_t resets;
     uint32_t words_read;
     uint32_t words_written;
+    uint32_t spi_transactions;      /* Number of SPI transactions (CS assertions) */
+    uint32_t dyn_conf_reads;        /* Number of dynamic reconfiguration reads */
+    uint32_t dyn_conf_writes;       /* Number of dynamic reconfiguration writes */
+    uint32_t dyn_conf_transactions; /* Number of SPI transactions used by dynamic reconfiguration reads and writes */
+    uint32_t readback_time_ms;      /* Time taken by the last successful SJA1105_ReadAllTables() */
+    uint32_t speed_change_time_ms;  /* Time the port was being reconfigured for in the last successful SJA1105_PortSetSpeed() */
+    uint32_t scrub_entries;         /* Number of table entries checked by SJA1105_Scrub() */
+    uint32_t scrub_mismatches;      /* Number of table entries found to be different on the device by SJA1105_Scrub() */
+    uint32_t scrub_repairs;         /* Number of table entries rewritten by SJA1105_Scrub() */
+    uint32_t storms_detected;       /* Number of storms started on any port by SJA1105_StormControlUpdate() */
+    uint32_t storms_ended;          /* Number of storms ended on any port by SJA1105_StormControlUpdate() */
+    uint32_t link_changes;          /* Number of port state changes seen by SJA1105_LinkMonitorPoll() */
+    uint32_t temperature_alarms;    /* Number of times the over-temperature alarm was raised */
+    uint32_t parity_repairs;        /* Number of RAM parity errors fixed by SJA1105_ParityRecover() rewriting only the corrupt entries */
+    uint32_t parity_reloads;        /* Number of RAM parity errors SJA1105_ParityRecover() had to reload the static configuration for */
+    uint32_t parity_repair_time_ms; /* Time taken by the last targeted repair attempt of SJA1105_ParityRecover() */
+    uint32_t parity_reload_time_ms; /* Time taken by the last static configuration reload of SJA1105_ParityRecover() */
+    uint32_t tables_copied;         /* Number of zero copy tables copied to RAM because they were changed */
     uint32_t crc_errors;
     uint32_t spi_errors;
     uint32_t mgmt_frames_sent;
@@ -218,6 +328,68 @@ typedef struct {
     uint32_t frames_dropped[SJA1105_NUM_PORTS];
 } sja1105_event_counters_t;
 
+/* Stores the original contents of every table entry changed during a transaction so they can be restored */
+typedef struct {
+    bool     open;                                                                         /* true = writes are deferred until SJA1105_TransactionCommit() */
+    uint8_t  num_entries;                                                                  /* Number of entries saved */
+    uint8_t  block_ids[SJA1105_TRANSACTION_MAX_ENTRIES];                                   /* Block ID of the table each entry belongs to */
+    uint16_t indices[SJA1105_TRANSACTION_MAX_ENTRIES];                                     /* Index of each entry in its table */
+    uint32_t backups[SJA1105_TRANSACTION_MAX_ENTRIES][SJA1105_TRANSACTION_MAX_ENTRY_SIZE]; /* Original contents of each entry */
+    bool     present[SJA1105_TRANSACTION_MAX_ENTRIES];                                     /* Whether each entry existed before the transaction. Only false for VLANs it added */
+    bool     dirty[SJA1105_TRANSACTION_MAX_ENTRIES];                                       /* Whether each entry had unwritten changes before the transaction */
+} sja1105_transaction_t;
+
+/* Position of SJA1105_Scrub() in the shadow tables */
+typedef struct {
+    uint8_t  table; /* Index of the table being checked in the list of readable tables */
+    uint16_t entry; /* Next entry of the table to check */
+} sja1105_scrubber_t;
+
+/* Ports put to sleep by SJA1105_PortSleep(). Each mask has bit n set for port n */
+typedef struct {
+    uint8_t asleep;  /* Ports that are asleep */
+    uint8_t ingress; /* Sleeping ports that had ingress enabled, restored by SJA1105_PortWake() */
+    uint8_t egress;  /* Sleeping ports that had egress enabled, restored by SJA1105_PortWake() */
+} sja1105_port_sleep_t;
+
+/* State of a port sampled by SJA1105_LinkMonitorPoll() */
+typedef struct {
+    sja1105_interface_t interface; /* xMII mode the port is running in */
+    sja1105_mode_t      mode;      /* Whether the port is acting as a MAC or a PHY */
+    sja1105_speed_t     speed;     /* Speed the port's MAC is running at */
+    bool                link_up;   /* Link state of the SGMII PCS. The xMII ports can't detect a link, so for them this is only false while the port is asleep */
+} sja1105_port_status_t;
+
+typedef void (*sja1105_callback_link_change_t)(sja1105_handle_t *dev, uint8_t port_num, const sja1105_port_status_t *old_status, const sja1105_port_status_t *new_status, void *context);
+
+/* Stores the last port states seen by SJA1105_LinkMonitorPoll() */
+typedef struct {
+    sja1105_port_status_t          status[SJA1105_NUM_PORTS];
+    sja1105_callback_link_change_t callbacks[SJA1105_NUM_PORTS]; /* Called from SJA1105_LinkMonitorPoll() with the mutex held when the port's state changes. NULL = no callback */
+    void                          *contexts[SJA1105_NUM_PORTS];  /* Passed to the port's callback */
+    bool                           sampled;                      /* true = status holds a previous sample to compare against */
+} sja1105_link_monitor_t;
+
+typedef void (*sja1105_callback_over_temperature_t)(sja1105_handle_t *dev, int16_t temp_x10, bool over, void *context);
+
+/* Over-temperature alarm raised by SJA1105_TemperatureMonitorUpdate() */
+typedef struct {
+    int16_t                             alarm_x10; /* Temperature in 0.1 degrees C at or above which callback is called with over = true */
+    int16_t                             clear_x10; /* Temperature in 0.1 degrees C below which callback is called with over = false. At most alarm_x10 */
+    sja1105_callback_over_temperature_t callback;  /* Called with the mutex held. NULL = no alarm */
+    void                               *context;   /* Passed to callback */
+} sja1105_temp_monitor_config_t;
+
+/* Temperature sensor state kept by SJA1105_TemperatureMonitorUpdate() */
+typedef struct {
+    sja1105_temp_monitor_config_t config;
+    uint8_t                       index;    /* Temperature sensor LUT entry of the last reading */
+    bool                          tracking; /* true = index holds a reading so only the neighbouring entries need to be probed */
+    bool                          over;     /* true = the alarm has been raised and not yet cleared */
+    atomic_int_least16_t          temp_x10; /* Last reading, read without the mutex by SJA1105_TemperatureGetCached() */
+    atomic_bool                   valid;    /* true = temp_x10 holds a reading */
+} sja1105_temp_monitor_t;
+
 /* Stores information about management routes */
 typedef struct {
     bool     slot_taken[SJA1105_NUM_MGMT_SLOTS]; /* true = slot has been taken */
@@ -255,14 +427,116 @@ struct sja1105_handle_t {
     sja1105_tables_t           tables;
     sja1105_event_counters_t   events;
     sja1105_mgmt_routes_t      management_routes;
+    sja1105_transaction_t      transaction;
+    sja1105_scrubber_t         scrubber;
+    sja1105_storm_control_t    storm_control[SJA1105_NUM_PORTS];
+    sja1105_port_sleep_t       port_sleep;
+    sja1105_link_monitor_t     link_monitor;
+    sja1105_temp_monitor_t     temp_monitor;
+    uint64_t                   ram_parity_repaired; /* Memories (see SJA1105_RAM_PARITY_MEMORIES()) repaired by SJA1105_ParityRecover(). Their parity errors stay set until the next reset */
+    sja1105_speed_t            sgmii_speed; /* Speed of the SGMII PCS, SJA1105_SPEED_DYNAMIC = autonegotiation. The MAC of the SGMII port always runs at 1G */
     atomic_bool                initialised;
 };
 
+/* State of the SGMII link reported by the PCS */
+typedef struct {
+    bool            link_up;
+    bool            autoneg_complete; /* Only set when autonegotiation is enabled */
+    bool            full_duplex;
+    sja1105_speed_t speed;            /* Autonegotiated speed, or the forced speed when autonegotiation is disabled */
+} sja1105_sgmii_status_t;
+
+/* What has to be done about the faults found by SJA1105_HealthCheck(), in order of severity */
+typedef enum {
+    SJA1105_HEALTH_OK       = 0x0, /* No faults */
+    SJA1105_HEALTH_DEGRADED = 0x1, /* Frames were dropped or an address couldn't be learned. Nothing needs to be repaired */
+    SJA1105_HEALTH_REPAIR   = 0x2, /* The tables on the device disagree with the shadow tables and should be rewritten, e.g. by SJA1105_Scrub() */
+    SJA1105_HEALTH_RESET    = 0x3  /* The configuration or a memory of the device is corrupt and it must be reset */
+} sja1105_health_action_t;
+
+/* Reasons frames were dropped on a port, read from its high level diagnostic counters */
+typedef struct {
+    uint32_t policing;       /* Exceeded the policer */
+    uint32_t ct_policing;    /* Critical traffic exceeded its policer */
+    uint32_t vl_not_found;   /* Critical traffic didn't match a virtual link */
+    uint32_t crc;            /* Bad FCS */
+    uint32_t size;           /* Too long or too short */
+    uint32_t unreleased;     /* Received while the port's ingress was disabled */
+    uint32_t vlan;           /* VLAN ID isn't allowed on the port */
+    uint32_t no_free_memory; /* No free buffers in the frame memory */
+} sja1105_drop_counters_t;
+
+/* Decoded status registers read by SJA1105_HealthCheck() */
+typedef struct {
+    bool                    config_valid;                     /* CONFIGS: the static configuration was accepted */
+    bool                    local_crc_error;                  /* CRCCHKL: a block of the last static configuration had a bad CRC */
+    bool                    global_crc_error;                 /* CRCCHKG: the last static configuration had a bad global CRC */
+    bool                    device_id_error;                  /* IDS: the last static configuration was for a different device */
+    bool                    l2_busy;                          /* L2BUSYS: the L2 lookup table is being initialised */
+    bool                    hash_conflict;                    /* HASHCONFS: an address couldn't be learned because its hash bucket was full */
+    uint16_t                hash_conflict_vid;                /* VLAN of the address that couldn't be learned */
+    uint8_t                 hash_conflict_addr[MAC_ADDR_SIZE]; /* Address that couldn't be learned */
+    bool                    vl_partition_error;               /* VLPARTS: a critical frame was dropped because its partition was full */
+    bool                    vl_route_error;                   /* VLROUTES: a critical frame was routed inconsistently with the VL forwarding table */
+    uint8_t                 vl_partition;                     /* VLPARIND: partition of the dropped critical frame */
+    uint16_t                vl_index;                         /* VLIND: virtual link of the dropped or misrouted critical frame */
+    bool                    forwarding_drop;                  /* FWDS: a frame was dropped because it had no destination port */
+    bool                    partition_drop;                   /* PARTS: a frame was dropped because its memory partition was full */
+    uint8_t                 drop_port;                        /* Port the dropped frame was received on. Only valid if forwarding_drop or partition_drop */
+    sja1105_drop_counters_t drop_counters;                    /* Drop counters of drop_port. Only valid if forwarding_drop or partition_drop */
+    uint32_t                ram_parity[2];                    /* RAMPARERRL/U: bit n set = parity error in memory n of the lower/upper register. Memories already repaired by SJA1105_ParityRecover() are cleared */
+    sja1105_health_action_t action;                           /* Most severe action needed for the faults above */
+} sja1105_health_t;
+
+/* Description of a static configuration image for SJA1105_ImageBuild() */
+typedef struct {
+    const uint32_t                *base;         /* Generic loader image providing every table not changed below (e.g. made with the vendor's configuration tool). Its xMII table must match the ports in the config */
+    uint32_t                       base_size;    /* Number of uint32_t in base */
+    const sja1105_vlan_t          *vlans;        /* VLANs added to (or replaced in) the VLAN lookup table. The base image must have a VLAN lookup table */
+    uint16_t                       num_vlans;
+    const sja1105_policer_t       *policers;     /* Replace the first num_policers entries of the L2 policing table. NULL = keep the base image's */
+    uint8_t                        num_policers;
+    const sja1105_l2_forwarding_t *forwarding;   /* Replace the forwarding entry of every port (SJA1105_NUM_PORTS entries). NULL = keep the base image's */
+} sja1105_image_spec_t;
+
+/* Receives consecutive parts of an exported static config, e.g. to write them to flash */
+typedef sja1105_status_t (*sja1105_callback_export_t)(sja1105_handle_t *dev, const uint32_t *data, uint32_t size, void *context);
+
+typedef enum {
+    SJA1105_LOADER_DEVICE_ID = 0x00, /* Waiting for the device ID */
+    SJA1105_LOADER_HEADER    = 0x01, /* Waiting for the block ID and size of the next block */
+    SJA1105_LOADER_BLOCK     = 0x02, /* Receiving the rest of a block */
+    SJA1105_LOADER_LAST      = 0x03, /* Receiving the global CRC of the last block */
+    SJA1105_LOADER_DONE      = 0x04, /* The whole static config has been received */
+    SJA1105_LOADER_FAILED    = 0x05, /* A block was rejected, SJA1105_LoaderEnd() must still be called */
+} sja1105_loader_state_t;
+
+/* State of a static config being loaded in chunks by SJA1105_LoaderFeed() */
+typedef struct {
+    sja1105_loader_state_t state;
+    bool                   stream;        /* Write blocks to the device as soon as they have been loaded (where possible) */
+    uint32_t               header[3];     /* Device ID, or the first words of the current block */
+    uint32_t              *block;         /* The current block, allocated once its size is known */
+    uint32_t               block_size;    /* Number of uint32_t in the current block including its header and CRCs */
+    uint32_t               received;      /* Number of bytes of the current header or block received */
+    uint32_t               total;         /* Number of uint32_t received */
+    uint32_t               streamed;      /* Bitmap of table indices already written to the device */
+    uint8_t                next_index;    /* Lowest table index that can still be written to the device */
+    uint32_t               offset;        /* Number of uint32_t written to the device */
+    uint32_t               crc_state;     /* Global CRC of the words written to the device so far, see SJA1105_CRC32Update() */
+    uint32_t               rle_control;   /* Control word of the current run of a compressed image */
+    uint8_t                rle_received;  /* Number of bytes of the control word received */
+    uint32_t               rle_remaining; /* Number of bytes left in the current literal run */
+} sja1105_loader_t;
+
 /* Stores informations from device status registers */
 typedef struct {
     uint64_t tx_bytes[SJA1105_NUM_PORTS];
     uint64_t rx_bytes[SJA1105_NUM_PORTS];
+    uint64_t tx_frames[SJA1105_NUM_PORTS];
+    uint64_t rx_frames[SJA1105_NUM_PORTS];
     uint32_t dropped_frames[SJA1105_NUM_PORTS];
+    uint32_t policed_frames[SJA1105_NUM_PORTS]; /* Frames dropped by the port's policers, also counted in dropped_frames */
 } sja1105_statistics_t;
 
 
@@ -274,6 +548,20 @@ sja1105_status_t SJA1105_Init(sja1105_handle_t *dev, const sja1105_config_t *con
 sja1105_status_t SJA1105_DeInit(sja1105_handle_t *dev, bool hard, bool clear_counters);
 sja1105_status_t SJA1105_ReInit(sja1105_handle_t *dev, const uint32_t *static_conf, uint32_t static_conf_size);
 
+/* Static configuration images (these don't use the device so can be run on the build host) */
+sja1105_status_t SJA1105_ImageBuild(const sja1105_config_t *config, const sja1105_callbacks_t *callbacks, const sja1105_image_spec_t *spec, uint32_t *image, uint32_t capacity, uint32_t *size);
+uint32_t         SJA1105_CRC32Update(uint32_t state, const uint32_t *data, uint32_t size);
+sja1105_status_t SJA1105_ImageValidate(const sja1105_config_t *config, const sja1105_callbacks_t *callbacks, const uint32_t *static_conf, uint32_t static_conf_size);
+sja1105_status_t SJA1105_ImageCompress(const uint32_t *image, uint32_t size, uint32_t *compressed, uint32_t capacity, uint32_t *compressed_size);
+
+/* Loading and saving static configurations */
+sja1105_status_t SJA1105_LoaderBegin(sja1105_handle_t *dev, sja1105_loader_t *loader, bool stream);
+sja1105_status_t SJA1105_LoaderFeed(sja1105_handle_t *dev, sja1105_loader_t *loader, const uint8_t *data, uint32_t length);
+sja1105_status_t SJA1105_LoaderFeedCompressed(sja1105_handle_t *dev, sja1105_loader_t *loader, const uint8_t *data, uint32_t length);
+sja1105_status_t SJA1105_LoaderEnd(sja1105_handle_t *dev, sja1105_loader_t *loader);
+sja1105_status_t SJA1105_ExportStaticConfig(sja1105_handle_t *dev, uint32_t *image, uint32_t capacity, uint32_t *size);
+sja1105_status_t SJA1105_ExportStaticConfigToSink(sja1105_handle_t *dev, sja1105_callback_export_t sink, void *context, uint32_t *size);
+
 /* Dynamic reconfiguration */
 sja1105_status_t SJA1105_PortGetState(sja1105_handle_t *dev, uint8_t port_num, bool *state);
 sja1105_status_t SJA1105_PortGetSpeed(sja1105_handle_t *dev, uint8_t port_num, sja1105_speed_t *speed);
@@ -281,14 +569,54 @@ sja1105_status_t SJA1105_PortSetSpeed(sja1105_handle_t *dev, uint8_t port_num, s
 sja1105_status_t SJA1105_PortSetLearning(sja1105_handle_t *dev, uint8_t port_num, bool enable);
 sja1105_status_t SJA1105_PortGetForwarding(sja1105_handle_t *dev, uint8_t port_num, bool *forwarding);
 sja1105_status_t SJA1105_PortSetForwarding(sja1105_handle_t *dev, uint8_t port_num, bool enable);
+sja1105_status_t SJA1105_PortsUpdate(sja1105_handle_t *dev, uint8_t port_mask, const sja1105_port_changes_t *changes);
+sja1105_status_t SJA1105_L2ForwardingGet(sja1105_handle_t *dev, uint8_t port_num, sja1105_l2_forwarding_t *forwarding);
+sja1105_status_t SJA1105_L2ForwardingSet(sja1105_handle_t *dev, uint8_t port_mask, const sja1105_l2_forwarding_t forwarding[SJA1105_NUM_PORTS]);
 sja1105_status_t SJA1105_PortSleep(sja1105_handle_t *dev, uint8_t port_num);
 sja1105_status_t SJA1105_PortWake(sja1105_handle_t *dev, uint8_t port_num);
+sja1105_status_t SJA1105_LinkMonitorSetCallback(sja1105_handle_t *dev, uint8_t port_num, sja1105_callback_link_change_t callback, void *context);
+sja1105_status_t SJA1105_LinkMonitorPoll(sja1105_handle_t *dev, uint8_t *changed);
+sja1105_status_t SJA1105_LinkMonitorGetStatus(sja1105_handle_t *dev, uint8_t port_num, sja1105_port_status_t *port_status);
+
+/* SGMII */
+sja1105_status_t SJA1105_SGMIIReadRegister(sja1105_handle_t *dev, uint16_t reg, uint16_t *value);
+sja1105_status_t SJA1105_SGMIIWriteRegister(sja1105_handle_t *dev, uint16_t reg, uint16_t value);
+sja1105_status_t SJA1105_SGMIIGetStatus(sja1105_handle_t *dev, sja1105_sgmii_status_t *sgmii_status);
+sja1105_status_t SJA1105_SGMIIRestartAutoneg(sja1105_handle_t *dev);
+
+/* Transactions */
+sja1105_status_t SJA1105_TransactionBegin(sja1105_handle_t *dev);
+sja1105_status_t SJA1105_TransactionCommit(sja1105_handle_t *dev);
+sja1105_status_t SJA1105_TransactionAbort(sja1105_handle_t *dev);
+
+/* VLANs */
+sja1105_status_t SJA1105_VLANGet(sja1105_handle_t *dev, uint16_t vid, sja1105_vlan_t *vlan, bool *present);
+sja1105_status_t SJA1105_VLANAdd(sja1105_handle_t *dev, const sja1105_vlan_t *vlan);
+sja1105_status_t SJA1105_VLANModify(sja1105_handle_t *dev, const sja1105_vlan_t *vlan);
+sja1105_status_t SJA1105_VLANRemove(sja1105_handle_t *dev, uint16_t vid);
+sja1105_status_t SJA1105_VLANSetMultiple(sja1105_handle_t *dev, const sja1105_vlan_t *vlans, uint16_t count);
+
+/* Policing */
+sja1105_status_t SJA1105_PolicerGet(sja1105_handle_t *dev, uint8_t index, sja1105_policer_t *policer);
+sja1105_status_t SJA1105_PolicerSet(sja1105_handle_t *dev, uint8_t index, const sja1105_policer_t *policer);
+sja1105_status_t SJA1105_StormControlConfigure(sja1105_handle_t *dev, uint8_t port_num, const sja1105_storm_control_config_t *config);
+sja1105_status_t SJA1105_StormControlUpdate(sja1105_handle_t *dev, const sja1105_statistics_t *stats);
 
 /* Maintenance */
 sja1105_status_t SJA1105_ReadTemperature(sja1105_handle_t *dev, float *temp);
+sja1105_status_t SJA1105_TemperatureMonitorConfigure(sja1105_handle_t *dev, const sja1105_temp_monitor_config_t *config);
+sja1105_status_t SJA1105_TemperatureMonitorUpdate(sja1105_handle_t *dev);
+sja1105_status_t SJA1105_TemperatureGetCached(sja1105_handle_t *dev, int16_t *temp_x10);
 sja1105_status_t SJA1105_CheckStatusRegisters(sja1105_handle_t *dev);
+sja1105_status_t SJA1105_HealthCheck(sja1105_handle_t *dev, sja1105_health_t *health);
 sja1105_status_t SJA1105_MACAddrTrapTest(sja1105_handle_t *dev, const uint8_t *addr, bool *trapped, bool *send_meta, bool *incl_srcpt);
 sja1105_status_t SJA1105_ReadAllTables(sja1105_handle_t *dev);
+sja1105_status_t SJA1105_Scrub(sja1105_handle_t *dev, uint16_t budget);
+sja1105_status_t SJA1105_ParityRecover(sja1105_handle_t *dev, bool *reloaded);
+sja1105_status_t SJA1105_TableGetDirty(sja1105_handle_t *dev, uint8_t block_id, uint16_t index, bool *dirty);
+sja1105_status_t SJA1105_TableCountDirty(sja1105_handle_t *dev, uint8_t block_id, uint32_t *count);
+sja1105_status_t SJA1105_TableClearDirty(sja1105_handle_t *dev, uint8_t block_id);
+sja1105_status_t SJA1105_SyncDirty(sja1105_handle_t *dev);
 sja1105_status_t SJA1105_ReadStatistics(sja1105_handle_t *dev, sja1105_statistics_t *stats);
 
 /* Utilities */
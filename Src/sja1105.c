@@ -6,6 +6,7 @@
  */
 
 #include "assert.h"
+#include "memory.h"
 
 #include "sja1105.h"
 #include "internal/sja1105_conf.h"
@@ -36,10 +37,19 @@ sja1105_status_t SJA1105_PortGetSpeed(sja1105_handle_t *dev, uint8_t port_num, s
     /* Check the device is initialised and take the mutex */
     SJA1105_LOCK;
 
+    /* Parameter checking */
+    if (port_num >= SJA1105_NUM_PORTS) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    /* The MAC of an SGMII port always runs at 1G so use the speed of the PCS */
+    if (dev->config->ports[port_num].interface == SJA1105_INTERFACE_SGMII) {
+        *speed = dev->sgmii_speed;
+    }
+
     /* For dynamic ports look at the MAC Configuration table */
-    if (dev->config->ports[port_num].speed == SJA1105_SPEED_DYNAMIC) {
+    else if (dev->config->ports[port_num].speed == SJA1105_SPEED_DYNAMIC) {
         status = SJA1105_MACConfTableGetSpeed(&dev->tables.mac_configuration, port_num, speed);
-        if (status != SJA1105_OK) return status;
+        if (status != SJA1105_OK) goto end;
     }
 
     /* For static ports look at the port config struct */
@@ -48,11 +58,16 @@ sja1105_status_t SJA1105_PortGetSpeed(sja1105_handle_t *dev, uint8_t port_num, s
     }
 
     /* Give the mutex and return */
+end:
     SJA1105_UNLOCK;
     return status;
 }
 
 
+/* Change the speed of a single port without disturbing the others. Only the port's MAC Configuration entry is written (using
+ * dynamic reconfiguration) and its clocks are only reprogrammed if they depend on the speed. The time the port spent
+ * reconfiguring is stored in events.speed_change_time_ms.
+ */
 sja1105_status_t __SJA1105_PortSetSpeed(sja1105_handle_t *dev, uint8_t port_num, sja1105_speed_t new_speed, bool recurse) {
 
     sja1105_status_t status = SJA1105_OK;
@@ -64,6 +79,8 @@ sja1105_status_t __SJA1105_PortSetSpeed(sja1105_handle_t *dev, uint8_t port_num,
     sja1105_speed_t       current_speed = SJA1105_SPEED_INVALID;
     bool                  revert        = false;
     sja1105_status_t      revert_status = SJA1105_OK;
+    bool                  set_clocks    = false;
+    uint32_t              start_time    = 0;
 
     /* Get the current speed */
     status = SJA1105_PortGetSpeed(dev, port_num, &current_speed);
@@ -78,47 +95,60 @@ sja1105_status_t __SJA1105_PortSetSpeed(sja1105_handle_t *dev, uint8_t port_num,
     if (new_speed == SJA1105_SPEED_DYNAMIC) status = SJA1105_PARAMETER_ERROR;   /* Speed shouldn't be set to dynamic after the initial configuration */
     if (new_speed >= SJA1105_SPEED_INVALID) status = SJA1105_PARAMETER_ERROR;   /* Invalid speed */
     if (port->configured == false) status = SJA1105_NOT_CONFIGURED_ERROR;       /* Port should have already been configured once with interface and voltage */
+    if (dev->transaction.open) status = SJA1105_BUSY;                           /* The clocks are reconfigured immediately so this can't be deferred by a transaction */
     if (status != SJA1105_OK) goto end;
 
-    /* TODO: Set SGMII speed */
+    /* Set SGMII port speed. The MAC stays at 1G and the PCS is forced to the new speed, which disables autonegotiation */
     if (port->interface == SJA1105_INTERFACE_SGMII) {
-        status = SJA1105_NOT_IMPLEMENTED_ERROR;
-        goto end;
+        start_time = dev->callbacks->callback_get_time_ms(dev);
+        status     = SJA1105_SGMIISetSpeed(dev, new_speed);
+        if (status != SJA1105_OK) {
+            revert = true;
+            goto end;
+        }
+        dev->events.speed_change_time_ms = dev->callbacks->callback_get_time_ms(dev) - start_time;
     }
 
     /* Set MII, RMII or RGMII port speed (AH1704 section 6.1) */
     else {
 
+        /* The clocks of RMII and MII MAC ports come from outside the switch and don't depend on the speed, so they are only
+         * set up the first time. Reprogramming them would stop the clock the PHY relies on. The ACU pad settings never depend
+         * on the speed, so they are left alone.
+         */
+        set_clocks  = current_speed == SJA1105_SPEED_DYNAMIC;
+        set_clocks |= port->interface == SJA1105_INTERFACE_RGMII;
+        set_clocks |= (port->interface == SJA1105_INTERFACE_MII) && (port->mode == SJA1105_MODE_PHY);
+
         /* Update the internal MAC Configuration table */
         status = SJA1105_MACConfTableSetSpeed(&dev->tables.mac_configuration, port_num, new_speed);
         if (status != SJA1105_OK) goto end;
 
         /* Write the internal MAC Configuration table to the device */
-        status = SJA1105_MACConfTableWrite(dev, port_num);
+        start_time = dev->callbacks->callback_get_time_ms(dev);
+        status     = SJA1105_MACConfTableWrite(dev, port_num);
         if (status != SJA1105_OK) {
             revert = true;
             goto end;
         }
 
-        /* Configure the ACU with new options */
-        status = SJA1105_ConfigureACUPort(dev, port_num, true);
-        if (status != SJA1105_OK) {
-            revert = true;
-            goto end;
+        /* Configure the CGU with new options. The MAC is set first so it never runs at the old speed with the new clocks */
+        if (set_clocks) {
+            status = SJA1105_ConfigureCGUPort(dev, port_num, true);
+            if (status != SJA1105_OK) {
+                revert = true;
+                goto end;
+            }
         }
 
-        /* Configure the CGU with new options */
-        status = SJA1105_ConfigureCGUPort(dev, port_num, true);
-        if (status != SJA1105_OK) {
-            revert = true;
-            goto end;
-        }
+        /* Record how long the port was being reconfigured for */
+        dev->events.speed_change_time_ms = dev->callbacks->callback_get_time_ms(dev) - start_time;
     }
 
 end:
 
     /* If the configuration failed midway then try to revert it (do not need to revert dynamic speed since this is only possible when configuring for the first time) */
-    if (revert && (current_speed != SJA1105_SPEED_DYNAMIC)) {
+    if (revert && recurse && (current_speed != SJA1105_SPEED_DYNAMIC)) {
         revert_status = __SJA1105_PortSetSpeed(dev, port_num, current_speed, false);
         if (revert_status != SJA1105_OK) status = SJA1105_REVERT_ERROR; /* Error while fixing an error! */
     }
@@ -135,45 +165,102 @@ sja1105_status_t SJA1105_PortSetSpeed(sja1105_handle_t *dev, uint8_t port_num, s
 }
 
 
-sja1105_status_t SJA1105_PortSetLearning(sja1105_handle_t *dev, uint8_t port_num, bool enable) {
+/* Apply the same MAC configuration changes to every port in port_mask. The shadow table is updated first, then only the
+ * entries that actually changed are written to the device back-to-back. If any write fails then the shadow table and the
+ * device are reverted to the original entries.
+ */
+sja1105_status_t SJA1105_PortsUpdate(sja1105_handle_t *dev, uint8_t port_mask, const sja1105_port_changes_t *changes) {
 
     sja1105_status_t status = SJA1105_OK;
 
     /* Check the device is initialised and take the mutex */
     SJA1105_LOCK;
 
+    sja1105_table_t *table = &dev->tables.mac_configuration;
+    uint32_t         backup[SJA1105_NUM_PORTS * SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE];
+    bool             backup_crc_valid;
+    uint8_t          changed_mask  = 0;
+    bool             written       = false;
+    bool             revert        = false;
     sja1105_status_t revert_status = SJA1105_OK;
-    bool             learning      = false;
 
-    /* Get the current port learning status */
-    status = SJA1105_MACConfTableGetDynLearn(&dev->tables.mac_configuration, port_num, &learning);
+    /* Argument checking */
+    if (port_mask >= (1 << SJA1105_NUM_PORTS)) status = SJA1105_PARAMETER_ERROR;
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) goto end;
+    if (*table->size != (SJA1105_NUM_PORTS * SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE)) status = SJA1105_STATIC_CONF_ERROR;
     if (status != SJA1105_OK) goto end;
 
-    /* New setting is different */
-    if (learning != enable) {
+    /* Save the original table so it can be restored */
+    memcpy(backup, table->data, sizeof(backup));
+    backup_crc_valid = table->data_crc_valid;
 
-        /* Update the internal MAC Configuration table */
-        status = SJA1105_MACConfTableSetDynLearn(&dev->tables.mac_configuration, port_num, enable);
-        if (status != SJA1105_OK) goto end;
+    /* Update the internal MAC Configuration table */
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        if (!(port_mask & (1 << port_num))) continue;
 
-        /* Write the internal MAC Configuration table to the device */
-        status = SJA1105_MACConfTableWrite(dev, port_num);
+        /* If a transaction is open save the entry so it can be rolled back */
+        status = SJA1105_TransactionJournal(dev, SJA1105_BLOCK_ID_MAC_CONF, port_num);
+        if (status != SJA1105_OK) {
+            revert = true;
+            goto end;
+        }
 
-        /* If an error occured revert the table */
+        if (changes->set_ingress) status = SJA1105_MACConfTableSetIngress(table, port_num, changes->ingress);
+        if ((status == SJA1105_OK) && changes->set_egress) status = SJA1105_MACConfTableSetEgress(table, port_num, changes->egress);
+        if ((status == SJA1105_OK) && changes->set_dyn_learn) status = SJA1105_MACConfTableSetDynLearn(table, port_num, changes->dyn_learn);
         if (status != SJA1105_OK) {
-            revert_status = SJA1105_MACConfTableSetDynLearn(&dev->tables.mac_configuration, port_num, learning);
-            if (revert_status != SJA1105_OK) status = SJA1105_REVERT_ERROR;
+            revert = true;
+            goto end;
+        }
+
+        /* Only write entries that are different */
+        if (memcmp(table->data + SJA1105_STATIC_CONF_MAC_CONF_WORD(port_num, 0), backup + SJA1105_STATIC_CONF_MAC_CONF_WORD(port_num, 0), SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE * sizeof(uint32_t)) != 0) {
+            changed_mask |= 1 << port_num;
+        }
+    }
+
+    /* Write the changed entries to the device */
+    if (changed_mask) {
+        written = true;
+        status  = SJA1105_MACConfTableWriteMultiple(dev, changed_mask);
+        if (status != SJA1105_OK) {
+            revert = true;
             goto end;
         }
     }
 
-/* Give the mutex and return */
 end:
+
+    /* If an error occured then restore the table, and the device if it was written to */
+    if (revert) {
+        memcpy(table->data, backup, sizeof(backup));
+        table->data_crc_valid = backup_crc_valid;
+        if (written) {
+            revert_status = SJA1105_MACConfTableWriteMultiple(dev, changed_mask);
+            if (revert_status != SJA1105_OK) status = SJA1105_REVERT_ERROR; /* Error while fixing an error! */
+        }
+    }
+
+    /* Give the mutex and return */
     SJA1105_UNLOCK;
     return status;
 }
 
 
+sja1105_status_t SJA1105_PortSetLearning(sja1105_handle_t *dev, uint8_t port_num, bool enable) {
+
+    const sja1105_port_changes_t changes = {
+        .set_dyn_learn = true,
+        .dyn_learn     = enable,
+    };
+
+    if (port_num >= SJA1105_NUM_PORTS) return SJA1105_PARAMETER_ERROR;
+
+    return SJA1105_PortsUpdate(dev, 1 << port_num, &changes);
+}
+
+
 sja1105_status_t SJA1105_PortGetForwarding(sja1105_handle_t *dev, uint8_t port_num, bool *forwarding) {
 
     sja1105_status_t status = SJA1105_OK;
@@ -206,36 +293,109 @@ end:
 
 sja1105_status_t SJA1105_PortSetForwarding(sja1105_handle_t *dev, uint8_t port_num, bool enable) {
 
+    const sja1105_port_changes_t changes = {
+        .set_ingress = true,
+        .ingress     = enable,
+        .set_egress  = true,
+        .egress      = enable,
+    };
+
+    if (port_num >= SJA1105_NUM_PORTS) return SJA1105_PARAMETER_ERROR;
+
+    return SJA1105_PortsUpdate(dev, 1 << port_num, &changes);
+}
+
+
+/* Get the L2 forwarding settings of a port */
+sja1105_status_t SJA1105_L2ForwardingGet(sja1105_handle_t *dev, uint8_t port_num, sja1105_l2_forwarding_t *forwarding) {
+
     sja1105_status_t status = SJA1105_OK;
+    sja1105_table_t *table  = &dev->tables.l2_forwarding;
 
     /* Check the device is initialised and take the mutex */
     SJA1105_LOCK;
 
-    sja1105_status_t revert_status = SJA1105_OK;
+    /* Parameter checking */
+    if (port_num >= SJA1105_NUM_PORTS) status = SJA1105_PARAMETER_ERROR;
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    SJA1105_L2ForwardingEntryUnpack(table->data + (port_num * SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE), forwarding);
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Change the L2 forwarding settings of every port in port_mask, using forwarding[port_num] for each. The changed entries are
+ * written back-to-back using dynamic reconfiguration, so ports can be isolated or rejoined without uploading the static config.
+ * If any write fails the table and device are restored.
+ */
+sja1105_status_t SJA1105_L2ForwardingSet(sja1105_handle_t *dev, uint8_t port_mask, const sja1105_l2_forwarding_t forwarding[SJA1105_NUM_PORTS]) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    sja1105_table_t *table = &dev->tables.l2_forwarding;
+    uint32_t         backup[SJA1105_NUM_PORTS * SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE];
+    bool             backup_crc_valid;
+    uint32_t         entry[SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE];
+    uint16_t         indices[SJA1105_NUM_PORTS];
+    uint32_t         count         = 0;
+    bool             written       = false;
     bool             revert        = false;
-    bool             ingress       = false;
-    bool             egress        = false;
+    sja1105_status_t revert_status = SJA1105_OK;
 
-    /* Get the current port ingress and egress status */
-    status = SJA1105_MACConfTableGetIngress(&dev->tables.mac_configuration, port_num, &ingress);
+    /* Argument checking */
+    if (port_mask >= (1 << SJA1105_NUM_PORTS)) status = SJA1105_PARAMETER_ERROR;
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
     if (status != SJA1105_OK) goto end;
-    status = SJA1105_MACConfTableGetEgress(&dev->tables.mac_configuration, port_num, &egress);
+    if (*table->size != SJA1105_STATIC_CONF_L2_FORWARDING_SIZE) status = SJA1105_STATIC_CONF_ERROR;
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        if (!(port_mask & (1 << port_num))) continue;
+        if (forwarding[port_num].reach_port >= (1 << SJA1105_NUM_PORTS)) status = SJA1105_PARAMETER_ERROR;
+        if (forwarding[port_num].bc_domain >= (1 << SJA1105_NUM_PORTS)) status = SJA1105_PARAMETER_ERROR;
+        if (forwarding[port_num].fl_domain >= (1 << SJA1105_NUM_PORTS)) status = SJA1105_PARAMETER_ERROR;
+        for (uint_fast8_t prio = 0; prio < SJA1105_NUM_PRIORITIES; prio++) {
+            if (forwarding[port_num].vlan_pmap[prio] >= SJA1105_NUM_PRIORITIES) status = SJA1105_PARAMETER_ERROR;
+        }
+    }
     if (status != SJA1105_OK) goto end;
 
-    /* New settings are different */
-    if ((ingress != enable) || (egress != enable)) {
+    /* Save the original entries so they can be restored */
+    memcpy(backup, table->data, sizeof(backup));
+    backup_crc_valid = table->data_crc_valid;
 
-        /* Update the internal MAC Configuration table */
-        status = SJA1105_MACConfTableSetIngress(&dev->tables.mac_configuration, port_num, enable);
-        if (status != SJA1105_OK) goto end;
-        status = SJA1105_MACConfTableSetEgress(&dev->tables.mac_configuration, port_num, enable);
+    /* Update the internal L2 forwarding table */
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        if (!(port_mask & (1 << port_num))) continue;
+
+        /* Start from the current entry so the packing keeps the bits that aren't forwarding settings */
+        memcpy(entry, table->data + (port_num * SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE), sizeof(entry));
+        SJA1105_L2ForwardingEntryPack(&forwarding[port_num], entry);
+
+        /* Only write entries that are different */
+        if (memcmp(entry, table->data + (port_num * SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE), sizeof(entry)) == 0) continue;
+
+        /* If a transaction is open save the entry so it can be rolled back */
+        status = SJA1105_TransactionJournal(dev, SJA1105_BLOCK_ID_L2_FORWARDING, port_num);
         if (status != SJA1105_OK) {
             revert = true;
             goto end;
         }
 
-        /* Write the internal MAC Configuration table to the device */
-        status = SJA1105_MACConfTableWrite(dev, port_num);
+        memcpy(table->data + (port_num * SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE), entry, sizeof(entry));
+        SJA1105_TableMarkDirty(table, port_num);
+        indices[count++] = port_num;
+    }
+
+    /* Write the changed entries to the device */
+    if (count > 0) {
+        written = true;
+        status  = SJA1105_DynTableWriteEntries(dev, SJA1105_BLOCK_ID_L2_FORWARDING, indices, count);
         if (status != SJA1105_OK) {
             revert = true;
             goto end;
@@ -244,15 +404,13 @@ sja1105_status_t SJA1105_PortSetForwarding(sja1105_handle_t *dev, uint8_t port_n
 
 end:
 
-    /* If an error occured then revert */
+    /* If an error occured then restore the table, and the device if it was written to */
     if (revert) {
-        revert_status = SJA1105_MACConfTableSetIngress(&dev->tables.mac_configuration, port_num, ingress);
-        if (revert_status != SJA1105_OK) {
-            status = SJA1105_REVERT_ERROR;
-        }
-        revert_status = SJA1105_MACConfTableSetEgress(&dev->tables.mac_configuration, port_num, egress);
-        if (revert_status != SJA1105_OK) {
-            status = SJA1105_REVERT_ERROR;
+        memcpy(table->data, backup, sizeof(backup));
+        table->data_crc_valid = backup_crc_valid;
+        if (written) {
+            revert_status = SJA1105_DynTableWriteEntries(dev, SJA1105_BLOCK_ID_L2_FORWARDING, indices, count);
+            if (revert_status != SJA1105_OK) status = SJA1105_REVERT_ERROR; /* Error while fixing an error! */
         }
     }
 
@@ -262,134 +420,1175 @@ end:
 }
 
 
-sja1105_status_t SJA1105_ReadTemperatureX10(sja1105_handle_t *dev, int16_t *temp_x10) {
-    /*TODO: Update table to enable TS*/
+/* Order that tables are written when a transaction is committed. VLANs and forwarding are set up before the MAC
+ * configuration so ports are only enabled once the rest of the configuration is in place.
+ */
+static const uint8_t SJA1105_TRANSACTION_ORDER[] = {
+    SJA1105_BLOCK_ID_VLAN_LOOKUP,
+    SJA1105_BLOCK_ID_L2_FORWARDING,
+    SJA1105_BLOCK_ID_MAC_CONF,
+};
+
+
+/* Write every changed entry of one table that has been saved by the transaction. If only_attempted is true then only
+ * entries marked in attempted are written (used when rolling back), otherwise the written entries are marked. VLANs that
+ * aren't in the shadow table are removed from the device using their saved entry, which holds their VLAN ID.
+ */
+static sja1105_status_t SJA1105_TransactionWriteTable(sja1105_handle_t *dev, uint8_t block_id, bool attempted[SJA1105_TRANSACTION_MAX_ENTRIES], bool only_attempted) {
+
+    sja1105_status_t       status      = SJA1105_OK;
+    sja1105_transaction_t *transaction = &dev->transaction;
+    uint16_t               indices[SJA1105_TRANSACTION_MAX_ENTRIES];
+    uint8_t                removals[SJA1105_TRANSACTION_MAX_ENTRIES];
+    uint32_t              *entry;
+    uint8_t                entry_size;
+    uint32_t               count        = 0;
+    uint32_t               num_removals = 0;
+    bool                   present;
+
+    /* Find the entries of this table */
+    for (uint_fast8_t i = 0; i < transaction->num_entries; i++) {
+        if (transaction->block_ids[i] != block_id) continue;
+        present = (block_id != SJA1105_BLOCK_ID_VLAN_LOOKUP) || SJA1105_VLANIsPresent(dev, transaction->indices[i]);
+
+        /* When rolling back only entries that may have been written need to be restored */
+        if (only_attempted) {
+            if (!attempted[i]) continue;
+        }
+
+        /* Skip entries that ended up the same as the original, including VLANs that were added and removed again */
+        else {
+            if (present && transaction->present[i]) {
+                status = SJA1105_TransactionGetEntry(dev, block_id, transaction->indices[i], &entry, &entry_size);
+                if (status != SJA1105_OK) return status;
+                if (memcmp(entry, transaction->backups[i], entry_size * sizeof(uint32_t)) == 0) continue;
+            }
+            if (!present && !transaction->present[i]) continue;
+            attempted[i] = true;
+        }
+
+        if (present) {
+            indices[count++] = transaction->indices[i];
+        } else {
+            removals[num_removals++] = i;
+        }
+    }
+
+    /* Write the entries back-to-back */
+    status = SJA1105_DynTableWriteEntries(dev, block_id, indices, count);
+    if (status != SJA1105_OK) return status;
+
+    /* Remove VLANs by writing their entry with VALIDENT cleared */
+    for (uint_fast8_t i = 0; i < num_removals; i++) {
+        status = SJA1105_DynConfWrite(dev, &SJA1105_DYN_CONF_VLAN_LOOKUP_DESC, 0, transaction->backups[removals[i]]);
+        if (status != SJA1105_OK) return status;
+    }
+
+    return status;
+}
+
+
+/* Check whether the transaction changed an entry that can only be applied by uploading the static config */
+static bool SJA1105_TransactionNeedsUpload(sja1105_handle_t *dev) {
+
+    sja1105_transaction_t *transaction = &dev->transaction;
+    uint32_t              *entry;
+    uint8_t                entry_size;
+
+    for (uint_fast8_t i = 0; i < transaction->num_entries; i++) {
+        if (SJA1105_DynTableIsWritable(transaction->block_ids[i])) continue;
+        if (SJA1105_TransactionGetEntry(dev, transaction->block_ids[i], transaction->indices[i], &entry, &entry_size) != SJA1105_OK) return true;
+        if (memcmp(entry, transaction->backups[i], entry_size * sizeof(uint32_t)) != 0) return true;
+    }
+
+    return false;
+}
+
+
+/* Start a transaction. The mutex is held until SJA1105_TransactionCommit() or SJA1105_TransactionAbort() is called
+ * (from the same thread), and all dynamic reconfiguration writes are deferred until the transaction is committed. MAC
+ * configuration, L2 forwarding, VLAN and policer changes can be part of a transaction, up to SJA1105_TRANSACTION_MAX_ENTRIES
+ * entries in total. Functions that reload or read back the tables return SJA1105_BUSY while one is open.
+ */
+sja1105_status_t SJA1105_TransactionBegin(sja1105_handle_t *dev) {
+
     sja1105_status_t status = SJA1105_OK;
 
     /* Check the device is initialised and take the mutex */
     SJA1105_LOCK;
 
-    /* Setup variables */
-    uint8_t  temp_low_i     = 0;
-    uint8_t  temp_high_i    = SJA1105_TS_LUT_SIZE;
-    uint8_t  guess          = 0;
-    uint8_t  previous_guess = 0;
-    uint32_t reg_data       = 0;
+    /* Transactions can't be nested */
+    if (dev->transaction.open) status = SJA1105_BUSY;
+    if (status != SJA1105_OK) {
+        SJA1105_UNLOCK;
+        return status;
+    }
 
-    /* Check the temperature sensor is enabled TODO: Check the internal ACU table instead */
-    status = SJA1105_ReadRegisterWithCheck(dev, SJA1105_ACU_REG_TS_CONFIG, &reg_data, 1);
-    if (status != SJA1105_OK) goto end;
+    /* Open the transaction, the mutex is given back when it is closed */
+    dev->transaction.open        = true;
+    dev->transaction.num_entries = 0;
 
-    /* Enable it if it isn't TODO: Modify the internal ACU table if it isn't */
-    if (reg_data & SJA1105_TS_PD) {
-        reg_data &= ~SJA1105_TS_PD;
-        status    = SJA1105_WriteRegister(dev, SJA1105_ACU_REG_TS_CONFIG, &reg_data, 1);
-        if (status != SJA1105_OK) goto end;
-        SJA1105_DELAY_MS(1); /* A slight delay to let the sensor stabilise */
+    return status;
+}
+
+
+/* Write all changes made since SJA1105_TransactionBegin() to the device. If an error occurs then the shadow tables are
+ * restored and any entries that may have been written are written again with their original contents. If a policer was
+ * changed the whole configuration is applied at once by uploading the static config (which briefly interrupts traffic and
+ * flushes learned addresses), and restored by uploading it again.
+ */
+sja1105_status_t SJA1105_TransactionCommit(sja1105_handle_t *dev) {
+
+    sja1105_status_t       status      = SJA1105_OK;
+    sja1105_transaction_t *transaction = &dev->transaction;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    bool             attempted[SJA1105_TRANSACTION_MAX_ENTRIES] = {false};
+    bool             revert                                     = false;
+    bool             upload                                     = false;
+    sja1105_status_t revert_status                              = SJA1105_OK;
+
+    /* Check there is a transaction to commit */
+    if (!transaction->open) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) {
+        SJA1105_UNLOCK;
+        return status;
     }
 
-    /* Perform a binary search for the temperature.  */
-    for (uint_fast8_t i = 0; i < 7; i++) {
+    /* Stop deferring writes */
+    transaction->open = false;
 
-        /* Calculate the next guess by splitting the range in half.
-         * If the guess is the same as the previous_guess then the guesses have converged on the answer. */
-        guess = (temp_low_i + temp_high_i) / 2;
-        if (guess == previous_guess) break;
+    /* Policers can't be dynamically reconfigured, so upload everything together */
+    upload = SJA1105_TransactionNeedsUpload(dev);
+    if (upload) {
+        status = SJA1105_SyncStaticConfig(dev);
+        if (status != SJA1105_OK) revert = true;
+        goto end;
+    }
+
+    /* Write the changed entries table by table */
+    for (uint_fast8_t i = 0; i < sizeof(SJA1105_TRANSACTION_ORDER); i++) {
+        status = SJA1105_TransactionWriteTable(dev, SJA1105_TRANSACTION_ORDER[i], attempted, false);
+        if (status != SJA1105_OK) {
+            revert = true;
+            goto end;
+        }
+    }
+
+end:
+
+    /* If an error occured then restore the shadow tables and undo any writes */
+    if (revert) {
+        SJA1105_TransactionRestore(dev);
+        if (upload) {
+            revert_status = SJA1105_SyncStaticConfig(dev);
+            if (revert_status != SJA1105_OK) status = SJA1105_REVERT_ERROR; /* Error while fixing an error! */
+        } else {
+            for (uint_fast8_t i = 0; i < sizeof(SJA1105_TRANSACTION_ORDER); i++) {
+                revert_status = SJA1105_TransactionWriteTable(dev, SJA1105_TRANSACTION_ORDER[i], attempted, true);
+                if (revert_status != SJA1105_OK) status = SJA1105_REVERT_ERROR; /* Error while fixing an error! */
+            }
+        }
+    }
+
+    /* Close the transaction */
+    transaction->num_entries = 0;
+
+    /* Give the mutex twice (once for this function and once for SJA1105_TransactionBegin()) and return */
+    SJA1105_UNLOCK;
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Discard all changes made since SJA1105_TransactionBegin(). Nothing has been written to the device so only the shadow
+ * tables need to be restored.
+ */
+sja1105_status_t SJA1105_TransactionAbort(sja1105_handle_t *dev) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Check there is a transaction to abort */
+    if (!dev->transaction.open) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) {
+        SJA1105_UNLOCK;
+        return status;
+    }
+
+    /* Restore the shadow tables and close the transaction */
+    SJA1105_TransactionRestore(dev);
+    dev->transaction.open        = false;
+    dev->transaction.num_entries = 0;
+
+    /* Give the mutex twice (once for this function and once for SJA1105_TransactionBegin()) and return */
+    SJA1105_UNLOCK;
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Get the settings of an entry in the L2 policing table, see SJA1105_POLICER_INDEX() and SJA1105_POLICER_BC_INDEX() */
+sja1105_status_t SJA1105_PolicerGet(sja1105_handle_t *dev, uint8_t index, sja1105_policer_t *policer) {
+
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_table_t *table  = &dev->tables.l2_policing;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) goto end;
+    if (((uint32_t) (index + 1) * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE) > *table->size) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    SJA1105_PolicerEntryUnpack(table->data + (index * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE), policer);
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Change an entry in the L2 policing table. Only the shadow table is changed, call SJA1105_SyncDirty() (or commit the open
+ * transaction) to apply the change. The L2 policing table can't be dynamically reconfigured so this uploads the static
+ * config, which briefly interrupts traffic and flushes learned addresses. Change every policer that needs changing before
+ * applying them so the changes are applied together.
+ */
+sja1105_status_t SJA1105_PolicerSet(sja1105_handle_t *dev, uint8_t index, const sja1105_policer_t *policer) {
 
-        /* Write to the TS_CONFIG register */
-        reg_data = guess & SJA1105_TS_THRESHOLD_MASK;
-        status   = SJA1105_WriteRegister(dev, SJA1105_ACU_REG_TS_CONFIG, &reg_data, 1);
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_table_t *table  = &dev->tables.l2_policing;
+    uint32_t         entry[SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE];
+    uint32_t        *shadow;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) goto end;
+    if (((uint32_t) (index + 1) * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE) > *table->size) status = SJA1105_PARAMETER_ERROR;
+    if ((policer->rate_bps / SJA1105_L2_POLICING_RATE_UNIT_BPS) > SJA1105_L2_POLICING_RATE_MAX) status = SJA1105_PARAMETER_ERROR;
+    if (policer->max_len > SJA1105_L2_POLICING_MAXLEN_MAX) status = SJA1105_PARAMETER_ERROR;
+    if (((uint32_t) (policer->sharindx + 1) * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE) > *table->size) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    /* Create the new entry */
+    shadow = table->data + (index * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE);
+    memcpy(entry, shadow, sizeof(entry));
+    SJA1105_PolicerEntryPack(policer, entry);
+
+    /* Only mark the entry as changed if it is different, so an unnecessary static config upload is avoided */
+    if (memcmp(entry, shadow, sizeof(entry)) != 0) {
+        status = SJA1105_TableMakeWritable(dev, table);
         if (status != SJA1105_OK) goto end;
 
-        /* Read from the TS_STATUS register */
-        status = SJA1105_ReadRegisterWithCheck(dev, SJA1105_ACU_REG_TS_STATUS, &reg_data, 1);
+        /* If a transaction is open save the entry so it can be rolled back */
+        status = SJA1105_TransactionJournal(dev, SJA1105_BLOCK_ID_L2_POLICING, index);
         if (status != SJA1105_OK) goto end;
 
-        /* Adjust the range based on the result */
-        if (reg_data & SJA1105_TS_EXCEEDED) {
-            temp_low_i = guess;
-        } else {
-            temp_high_i = guess;
+        shadow = table->data + (index * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE);
+        memcpy(shadow, entry, sizeof(entry));
+        SJA1105_TableMarkDirty(table, index);
+    }
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Configure storm control for a port. If the port is in a storm the storm is ended without calling the callback */
+sja1105_status_t SJA1105_StormControlConfigure(sja1105_handle_t *dev, uint8_t port_num, const sja1105_storm_control_config_t *config) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (!dev->tables.l2_policing.in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (port_num >= SJA1105_NUM_PORTS) status = SJA1105_PARAMETER_ERROR;
+    if (config->release_fps > config->trigger_fps) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    /* Start measuring again with the new settings */
+    dev->storm_control[port_num].config  = *config;
+    dev->storm_control[port_num].active  = false;
+    dev->storm_control[port_num].quiet   = false;
+    dev->storm_control[port_num].sampled = false;
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Run storm control using statistics from SJA1105_ReadStatistics(), call this periodically (e.g. every 100ms). Storms are
+ * detected from the rate of frames dropped by each port's policers and reported through the port's callback and the storm
+ * counters. The policers aren't changed, since the L2 policing table can't be dynamically reconfigured and uploading the
+ * static config would interrupt traffic on every port. The received frame counters aren't used as they also count unicast.
+ */
+sja1105_status_t SJA1105_StormControlUpdate(sja1105_handle_t *dev, const sja1105_statistics_t *stats) {
+
+    sja1105_status_t         status = SJA1105_OK;
+    sja1105_storm_control_t *sc;
+    uint32_t                 now;
+    bool                     report;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    now = dev->callbacks->callback_get_time_ms(dev);
+    for (uint_fast8_t port = 0; port < SJA1105_NUM_PORTS; port++) {
+        sc     = &dev->storm_control[port];
+        report = false;
+        if (!sc->config.enabled) continue;
+
+        /* Need a previous sample to measure the rate. If the counter went backwards the switch was reset so start again */
+        if (sc->sampled && (stats->policed_frames[port] >= sc->last_drops)) {
+            if (now == sc->last_time) continue;
+            sc->rate_fps = (uint32_t) CONSTRAIN(((uint64_t) (stats->policed_frames[port] - sc->last_drops) * 1000) / (now - sc->last_time), 0, UINT32_MAX);
+
+            /* Start a storm as soon as the rate reaches the trigger */
+            if (!sc->active && (sc->rate_fps >= sc->config.trigger_fps)) {
+                sc->active = true;
+                sc->quiet  = false;
+                sc->storms++;
+                dev->events.storms_detected++;
+                report = true;
+            }
+
+            /* End the storm once the rate has stayed below the release threshold for the hold time */
+            else if (sc->active && (sc->rate_fps < sc->config.release_fps)) {
+                if (!sc->quiet) {
+                    sc->quiet       = true;
+                    sc->quiet_since = now;
+                }
+                if ((now - sc->quiet_since) >= sc->config.hold_ms) {
+                    sc->active = false;
+                    sc->quiet  = false;
+                    dev->events.storms_ended++;
+                    report = true;
+                }
+            } else {
+                sc->quiet = false;
+            }
         }
 
-        previous_guess = guess;
+        sc->last_drops = stats->policed_frames[port];
+        sc->last_time  = now;
+        sc->sampled    = true;
+
+        if (report && (sc->config.callback != NULL)) sc->config.callback(dev, port, sc->active, sc->rate_fps, sc->config.context);
     }
 
-    /* Check the answer is valid */
-    if ((guess >= SJA1105_TS_LUT_SIZE) || (guess == 0)) status = SJA1105_ERROR;
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Get the VLAN lookup table entry for a VLAN ID. If the VLAN doesn't exist present is false and vlan is unchanged */
+sja1105_status_t SJA1105_VLANGet(sja1105_handle_t *dev, uint16_t vid, sja1105_vlan_t *vlan, bool *present) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t        *entry  = NULL;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (vid >= SJA1105_NUM_VLAN_IDS) status = SJA1105_PARAMETER_ERROR;
+    if (!dev->tables.vlan_lookup.in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    /* Look up the entry using the index */
+    entry    = SJA1105_VLANGetEntry(dev, vid);
+    *present = entry != NULL;
+    if (entry != NULL) SJA1105_VLANEntryUnpack(entry, vlan);
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Add or change VLAN lookup table entries in the shadow table then write them to the device back-to-back. If add is false
+ * every VLAN must already exist, if modify is false none of them may exist. If a write fails the remaining entries are
+ * left marked as dirty and can be written later with SJA1105_SyncDirty().
+ */
+static sja1105_status_t SJA1105_VLANSet(sja1105_handle_t *dev, const sja1105_vlan_t *vlans, uint16_t count, bool add, bool modify) {
+
+    sja1105_status_t status  = SJA1105_OK;
+    sja1105_table_t *table   = &dev->tables.vlan_lookup;
+    uint16_t         num_new = 0;
+    uint16_t         vids[SJA1105_DYN_CONF_MAX_BATCH];
+    uint32_t         entry[SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE];
+    uint32_t        *shadow;
+    uint16_t         batch;
+
+    /* Parameter checking */
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) return status;
+    for (uint_fast16_t i = 0; i < count; i++) {
+        if (vlans[i].vid >= SJA1105_NUM_VLAN_IDS) status = SJA1105_PARAMETER_ERROR;
+        if (!add && !SJA1105_VLANIsPresent(dev, vlans[i].vid)) status = SJA1105_PARAMETER_ERROR;
+        if (!modify && SJA1105_VLANIsPresent(dev, vlans[i].vid)) status = SJA1105_ALREADY_CONFIGURED_ERROR;
+        if (status != SJA1105_OK) return status;
+        if (!SJA1105_VLANIsPresent(dev, vlans[i].vid)) num_new++;
+    }
+
+    /* Make space for every new entry at once */
+    status = SJA1105_VLANTableReserve(dev, num_new);
+    if (status != SJA1105_OK) return status;
+
+    for (uint_fast16_t i = 0; i < count; i += batch) {
+        batch = CONSTRAIN(count - i, 0, SJA1105_DYN_CONF_MAX_BATCH);
+
+        /* Update the shadow table, saving the original entries if a transaction is open */
+        for (uint_fast8_t j = 0; j < batch; j++) {
+            status = SJA1105_TransactionJournal(dev, SJA1105_BLOCK_ID_VLAN_LOOKUP, vlans[i + j].vid);
+            if (status != SJA1105_OK) return status;
+            SJA1105_VLANEntryPack(&vlans[i + j], entry);
+            shadow = SJA1105_VLANGetEntry(dev, vlans[i + j].vid);
+            if (shadow != NULL) {
+                memcpy(shadow, entry, sizeof(entry));
+            } else {
+                status = SJA1105_VLANTableAppend(dev, entry);
+                if (status != SJA1105_OK) return status;
+            }
+            SJA1105_TableMarkDirty(table, vlans[i + j].vid);
+            vids[j] = vlans[i + j].vid;
+        }
+
+        /* Write the entries with VALIDENT set so new VLANs are added */
+        status = SJA1105_DynTableWriteEntries(dev, SJA1105_BLOCK_ID_VLAN_LOOKUP, vids, batch);
+        if (status != SJA1105_OK) return status;
+    }
+
+    return status;
+}
+
+
+/* Add a VLAN that doesn't exist yet */
+sja1105_status_t SJA1105_VLANAdd(sja1105_handle_t *dev, const sja1105_vlan_t *vlan) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    status = SJA1105_VLANSet(dev, vlan, 1, true, false);
+
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Change the ports of a VLAN that already exists */
+sja1105_status_t SJA1105_VLANModify(sja1105_handle_t *dev, const sja1105_vlan_t *vlan) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    status = SJA1105_VLANSet(dev, vlan, 1, false, true);
+
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Add or change several VLANs. This is much faster than adding them one at a time because the shadow table is only grown
+ * once and the entries are written to the device back-to-back.
+ */
+sja1105_status_t SJA1105_VLANSetMultiple(sja1105_handle_t *dev, const sja1105_vlan_t *vlans, uint16_t count) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    status = SJA1105_VLANSet(dev, vlans, count, true, true);
+
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Remove a VLAN from the device and the shadow table */
+sja1105_status_t SJA1105_VLANRemove(sja1105_handle_t *dev, uint16_t vid) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t        *entry  = NULL;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (!dev->tables.vlan_lookup.in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) goto end;
+    entry = SJA1105_VLANGetEntry(dev, vid);
+    if (entry == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    /* If a transaction is open save the entry so it can be added back, the device is only written when it is committed */
+    status = SJA1105_TransactionJournal(dev, SJA1105_BLOCK_ID_VLAN_LOOKUP, vid);
+    if (status != SJA1105_OK) goto end;
+
+    /* Write the entry with VALIDENT cleared to remove it from the device */
+    if (!dev->transaction.open) {
+        status = SJA1105_DynConfWrite(dev, &SJA1105_DYN_CONF_VLAN_LOOKUP_DESC, 0, entry);
+        if (status != SJA1105_OK) goto end;
+    }
+
+    /* Remove it from the shadow table */
+    status = SJA1105_VLANTableRemove(dev, vid);
+    if (status != SJA1105_OK) goto end;
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Power up the temperature sensor. It is enabled in the ACU table too so it stays powered after a static config upload */
+static sja1105_status_t SJA1105_TemperatureEnable(sja1105_handle_t *dev) {
+
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_table_t *table  = &dev->tables.acu_config_parameters;
+    uint32_t         reg_data;
+
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Already enabled */
+    if (!(table->data[SJA1105_ACU_TABLE_TS_CONFIG_INDEX] & SJA1105_TS_PD)) return status;
+
+    table->data[SJA1105_ACU_TABLE_TS_CONFIG_INDEX] &= ~SJA1105_TS_PD;
+    table->data_crc_valid                           = false;
+
+    reg_data = table->data[SJA1105_ACU_TABLE_TS_CONFIG_INDEX];
+    status   = SJA1105_WriteRegister(dev, SJA1105_ACU_REG_TS_CONFIG, &reg_data, 1);
+    if (status != SJA1105_OK) return status;
+    SJA1105_DELAY_MS(1); /* A slight delay to let the sensor stabilise */
+
+    return status;
+}
+
+
+/* Check if the temperature is at or above SJA1105_TS_LUT[index] */
+static sja1105_status_t SJA1105_TemperatureProbe(sja1105_handle_t *dev, uint8_t index, bool *exceeded) {
+
+    sja1105_status_t status   = SJA1105_OK;
+    uint32_t         reg_data = index & SJA1105_TS_THRESHOLD_MASK;
+
+    /* Write to the TS_CONFIG register */
+    status = SJA1105_WriteRegister(dev, SJA1105_ACU_REG_TS_CONFIG, &reg_data, 1);
+    if (status != SJA1105_OK) return status;
+
+    /* Read from the TS_STATUS register */
+    status = SJA1105_ReadRegisterWithCheck(dev, SJA1105_ACU_REG_TS_STATUS, &reg_data, 1);
+    if (status != SJA1105_OK) return status;
+
+    *exceeded = (reg_data & SJA1105_TS_EXCEEDED) != 0;
+
+    return status;
+}
+
+
+/* Find the LUT entry of the temperature with a binary search */
+static sja1105_status_t SJA1105_TemperatureSearch(sja1105_handle_t *dev, uint8_t *index) {
+
+    sja1105_status_t status         = SJA1105_OK;
+    uint8_t          temp_low_i     = 0;
+    uint8_t          temp_high_i    = SJA1105_TS_LUT_SIZE;
+    uint8_t          guess          = 0;
+    uint8_t          previous_guess = 0;
+    bool             exceeded;
+
+    for (uint_fast8_t i = 0; i < 7; i++) {
+
+        /* Calculate the next guess by splitting the range in half.
+         * If the guess is the same as the previous_guess then the guesses have converged on the answer. */
+        guess = (temp_low_i + temp_high_i) / 2;
+        if (guess == previous_guess) break;
+
+        status = SJA1105_TemperatureProbe(dev, guess, &exceeded);
+        if (status != SJA1105_OK) return status;
+
+        /* Adjust the range based on the result */
+        if (exceeded) {
+            temp_low_i = guess;
+        } else {
+            temp_high_i = guess;
+        }
+
+        previous_guess = guess;
+    }
+
+    /* Check the answer is valid */
+    if ((guess >= SJA1105_TS_LUT_SIZE) || (guess == 0)) status = SJA1105_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    *index = guess;
+
+    return status;
+}
+
+
+/* Save a reading for SJA1105_TemperatureGetCached() and raise or clear the over-temperature alarm */
+static void SJA1105_TemperaturePublish(sja1105_handle_t *dev, uint8_t index) {
+
+    sja1105_temp_monitor_t *tm       = &dev->temp_monitor;
+    int16_t                 temp_x10 = SJA1105_TS_LUT[index];
+
+    tm->index    = index;
+    tm->tracking = true;
+    tm->temp_x10 = temp_x10;
+    tm->valid    = true;
+
+    if (tm->config.callback == NULL) return;
+    if (!tm->over && (temp_x10 >= tm->config.alarm_x10)) {
+        tm->over = true;
+        dev->events.temperature_alarms++;
+        tm->config.callback(dev, temp_x10, true, tm->config.context);
+    } else if (tm->over && (temp_x10 < tm->config.clear_x10)) {
+        tm->over = false;
+        tm->config.callback(dev, temp_x10, false, tm->config.context);
+    }
+}
+
+
+/* Read the temperature with a binary search over the sensor's thresholds. This takes up to 7 write/read pairs, use
+ * SJA1105_TemperatureMonitorUpdate() and SJA1105_TemperatureGetCached() to read the temperature periodically.
+ */
+sja1105_status_t SJA1105_ReadTemperatureX10(sja1105_handle_t *dev, int16_t *temp_x10) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint8_t          index  = 0;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    status = SJA1105_TemperatureEnable(dev);
+    if (status != SJA1105_OK) goto end;
+
+    status = SJA1105_TemperatureSearch(dev, &index);
+    if (status != SJA1105_OK) goto end;
+
+    /* Get the temp (multiplied by 10). E.g. temp_x10 = 364 means 36.4 degrees */
+    /* Note that this is the lower end of the range, and the answer could be up to SJA1105_TS_LUT[index + 1]*/
+    SJA1105_TemperaturePublish(dev, index);
+    *temp_x10 = SJA1105_TS_LUT[index];
+
+/* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+sja1105_status_t SJA1105_ReadTemperature(sja1105_handle_t *dev, float *temp) {
+    int16_t          temperatureX10;
+    sja1105_status_t status = SJA1105_ReadTemperatureX10(dev, &temperatureX10);
+    *temp                   = (float) temperatureX10 / 10.0;
+    return status;
+}
+
+/* Set the over-temperature alarm. The alarm is re-evaluated at the next reading */
+sja1105_status_t SJA1105_TemperatureMonitorConfigure(sja1105_handle_t *dev, const sja1105_temp_monitor_config_t *config) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (config->clear_x10 > config->alarm_x10) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    dev->temp_monitor.config = *config;
+    dev->temp_monitor.over   = false;
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Update the cached temperature. Call this periodically from a background task. After the first reading only the LUT entries
+ * either side of the last reading are probed, so a steady temperature costs 2 write/read pairs instead of a full binary
+ * search. A large rise is followed over several calls, moving at most SJA1105_TS_MAX_TRACK_STEPS entries per call (each
+ * reading is still a valid lower bound). A fall of more than SJA1105_TS_MAX_TRACK_STEPS entries is found with a full search.
+ */
+sja1105_status_t SJA1105_TemperatureMonitorUpdate(sja1105_handle_t *dev) {
+
+    sja1105_status_t        status = SJA1105_OK;
+    sja1105_temp_monitor_t *tm     = &dev->temp_monitor;
+    uint8_t                 index;
+    bool                    exceeded;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    status = SJA1105_TemperatureEnable(dev);
+    if (status != SJA1105_OK) goto end;
+
+    /* Without a previous reading the whole LUT has to be searched */
+    if (!tm->tracking) {
+        status = SJA1105_TemperatureSearch(dev, &index);
+        if (status != SJA1105_OK) goto end;
+        SJA1105_TemperaturePublish(dev, index);
+        goto end;
+    }
+
+    /* Check if the temperature has fallen below the last entry */
+    index  = tm->index;
+    status = SJA1105_TemperatureProbe(dev, index, &exceeded);
+    if (status != SJA1105_OK) goto end;
+
+    /* Move down until an entry is exceeded */
+    if (!exceeded) {
+        for (uint_fast8_t step = 0; (step < SJA1105_TS_MAX_TRACK_STEPS) && !exceeded; step++) {
+            if (index <= 1) {
+                status = SJA1105_ERROR; /* Below the range of the sensor */
+                goto end;
+            }
+            index--;
+            status = SJA1105_TemperatureProbe(dev, index, &exceeded);
+            if (status != SJA1105_OK) goto end;
+        }
+
+        /* The temperature is still below the lowest entry probed, so publishing it would report a reading that is too high */
+        if (!exceeded) {
+            status = SJA1105_TemperatureSearch(dev, &index);
+            if (status != SJA1105_OK) goto end;
+        }
+    }
+
+    /* Otherwise move up while the next entry is exceeded */
+    else {
+        for (uint_fast8_t step = 0; (step < SJA1105_TS_MAX_TRACK_STEPS) && ((index + 1) < SJA1105_TS_LUT_SIZE); step++) {
+            status = SJA1105_TemperatureProbe(dev, index + 1, &exceeded);
+            if (status != SJA1105_OK) goto end;
+            if (!exceeded) break;
+            index++;
+        }
+    }
+
+    SJA1105_TemperaturePublish(dev, index);
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Get the temperature from the last reading without taking the mutex or using the SPI bus. The value is the lower end of the
+ * sensor's range, like SJA1105_ReadTemperatureX10().
+ */
+sja1105_status_t SJA1105_TemperatureGetCached(sja1105_handle_t *dev, int16_t *temp_x10) {
+
+    if (!dev->initialised) return SJA1105_NOT_CONFIGURED_ERROR;
+    if (!dev->temp_monitor.valid) return SJA1105_NOT_CONFIGURED_ERROR;
+
+    *temp_x10 = dev->temp_monitor.temp_x10;
+
+    return SJA1105_OK;
+}
+
+
+/* Read the status registers in a single burst and decode every flag into health. The drop counters of the port that dropped a
+ * frame are fetched with a second burst since they are in another block. health->action says what needs to be done about the
+ * faults. Only frames dropped by the switch are counted in the event counters, faults don't return an error.
+ */
+sja1105_status_t SJA1105_HealthCheck(sja1105_handle_t *dev, sja1105_health_t *health) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         status_registers[SJA1105_REGULAR_CHECK_SIZE];
+    uint32_t         drop_registers[SJA1105_HIGH_LEVEL_STATS_DROP_SIZE];
+    uint32_t         reg_data;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    memset(health, 0, sizeof(*health));
+
+    /* Read the status registers */
+    status = SJA1105_ReadRegister(dev, SJA1105_REGULAR_CHECK_ADDR, status_registers, SJA1105_REGULAR_CHECK_SIZE);
+    if (status != SJA1105_OK) goto end;
+
+    /* Static configuration flags */
+    reg_data                 = status_registers[SJA1105_REGULAR_CHECK_INDEX(SJA1105_REG_STATIC_CONF_FLAGS)];
+    health->config_valid     = (reg_data & SJA1105_CONFIGS_MASK) != 0;
+    health->local_crc_error  = (reg_data & SJA1105_CRCCHKL_MASK) != 0;
+    health->global_crc_error = (reg_data & SJA1105_CRCCHKG_MASK) != 0;
+    health->device_id_error  = (reg_data & SJA1105_IDS_MASK) != 0;
+
+    /* Virtual link status */
+    reg_data                   = status_registers[SJA1105_REGULAR_CHECK_INDEX(SJA1105_REG_VL_PART_STATUS)];
+    health->vl_partition_error = (reg_data & SJA1105_VLPARTS) != 0;
+    health->vl_route_error     = (reg_data & SJA1105_VLROUTES) != 0;
+    health->vl_partition       = (reg_data & SJA1105_VLPARIND_MASK) >> SJA1105_VLPARIND_SHIFT;
+    health->vl_index           = (reg_data & SJA1105_VLIND_MASK) >> SJA1105_VLIND_SHIFT;
+
+    /* L2 lookup status */
+    reg_data        = status_registers[SJA1105_REGULAR_CHECK_INDEX(SJA1105_REG_GENERAL_STATUS_1)];
+    health->l2_busy = (reg_data & SJA1105_L2BUSYS_MASK) != 0;
+
+    /* Hash conflicts (general status 2 holds the L2 address, not the conflict). The address is sent most significant byte
+     * first so the lower 16 bits are the last two bytes
+     */
+    reg_data                  = status_registers[SJA1105_REGULAR_CHECK_INDEX(SJA1105_REG_GENERAL_STATUS_3)];
+    health->hash_conflict     = (reg_data & SJA1105_HASHCONFS) != 0;
+    health->hash_conflict_vid = (reg_data & SJA1105_VLANIDHC_MASK) >> SJA1105_VLANIDHC_SHIFT;
+    if (health->hash_conflict) {
+        uint16_t addr_low = (reg_data & SJA1105_MACADDL_MASK) >> SJA1105_MACADDL_SHIFT;
+        uint32_t addr_high = status_registers[SJA1105_REGULAR_CHECK_INDEX(SJA1105_REG_GENERAL_STATUS_4)];
+        for (uint_fast8_t i = 0; i < 4; i++) health->hash_conflict_addr[i] = (addr_high >> (8 * (3 - i))) & 0xff;
+        health->hash_conflict_addr[4] = (addr_low >> 8) & 0xff;
+        health->hash_conflict_addr[5] = addr_low & 0xff;
+    }
+
+    /* Frames dropped due to forwarding or no free memory */
+    reg_data                = status_registers[SJA1105_REGULAR_CHECK_INDEX(SJA1105_REG_GENERAL_STATUS_9)];
+    health->forwarding_drop = (reg_data & SJA1105_FWDS) != 0;
+    health->partition_drop  = (reg_data & SJA1105_PARTS) != 0;
+    health->drop_port       = (reg_data & SJA1105_FWDS_PARTS_PORT_MASK) >> SJA1105_FWDS_PARTS_PORT_SHIFT;
+
+    /* RAM parity errors */
+    health->ram_parity[0] = status_registers[SJA1105_REGULAR_CHECK_INDEX(SJA1105_REG_GENERAL_STATUS_10)] & ~(uint32_t) dev->ram_parity_repaired;
+    health->ram_parity[1] = status_registers[SJA1105_REGULAR_CHECK_INDEX(SJA1105_REG_GENERAL_STATUS_11)] & ~(uint32_t) (dev->ram_parity_repaired >> 32);
+
+    /* Find out why the frame was dropped */
+    if (health->forwarding_drop || health->partition_drop) {
+        if (health->drop_port >= SJA1105_NUM_PORTS) {
+            status = SJA1105_INVALID_VALUE_ERROR;
+            goto end;
+        }
+        dev->events.frames_dropped[health->drop_port]++;
+
+        status = SJA1105_ReadRegister(dev, SJA1105_REG_HIGH_LEVEL_STATS_PORT0 + SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(health->drop_port) + SJA1105_HIGH_LEVEL_STATS_N_POLERR, drop_registers, SJA1105_HIGH_LEVEL_STATS_DROP_SIZE);
+        if (status != SJA1105_OK) goto end;
+
+        health->drop_counters.policing       = drop_registers[SJA1105_HIGH_LEVEL_STATS_N_POLERR - SJA1105_HIGH_LEVEL_STATS_N_POLERR];
+        health->drop_counters.ct_policing    = drop_registers[SJA1105_HIGH_LEVEL_STATS_N_CTPOLERR - SJA1105_HIGH_LEVEL_STATS_N_POLERR];
+        health->drop_counters.vl_not_found   = drop_registers[SJA1105_HIGH_LEVEL_STATS_N_VLNOTFOUND - SJA1105_HIGH_LEVEL_STATS_N_POLERR];
+        health->drop_counters.crc            = drop_registers[SJA1105_HIGH_LEVEL_STATS_N_CRCERR - SJA1105_HIGH_LEVEL_STATS_N_POLERR];
+        health->drop_counters.size           = drop_registers[SJA1105_HIGH_LEVEL_STATS_N_SIZEERR - SJA1105_HIGH_LEVEL_STATS_N_POLERR];
+        health->drop_counters.unreleased     = drop_registers[SJA1105_HIGH_LEVEL_STATS_N_UNRELEASED - SJA1105_HIGH_LEVEL_STATS_N_POLERR];
+        health->drop_counters.vlan           = drop_registers[SJA1105_HIGH_LEVEL_STATS_N_VLANERR - SJA1105_HIGH_LEVEL_STATS_N_POLERR];
+        health->drop_counters.no_free_memory = drop_registers[SJA1105_HIGH_LEVEL_STATS_N_N664ERR - SJA1105_HIGH_LEVEL_STATS_N_POLERR];
+    }
+
+    /* Classify the faults. A corrupt memory or configuration can only be fixed by a reset. A misrouted critical frame means the
+     * VL tables on the device don't match the shadow tables, which can be fixed by rewriting them. Dropped frames and hash
+     * conflicts are normal under load.
+     */
+    if (health->ram_parity[0] || health->ram_parity[1] || !health->config_valid || health->local_crc_error || health->global_crc_error || health->device_id_error) {
+        health->action = SJA1105_HEALTH_RESET;
+    } else if (health->vl_route_error) {
+        health->action = SJA1105_HEALTH_REPAIR;
+    } else if (health->vl_partition_error || health->forwarding_drop || health->partition_drop || health->hash_conflict) {
+        health->action = SJA1105_HEALTH_DEGRADED;
+    } else {
+        health->action = SJA1105_HEALTH_OK;
+    }
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Check the status registers and return an error for faults that need a reset */
+sja1105_status_t SJA1105_CheckStatusRegisters(sja1105_handle_t *dev) {
+
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_health_t health;
+
+    status = SJA1105_HealthCheck(dev, &health);
+    if (status != SJA1105_OK) return status;
+
+    if (health.ram_parity[0] || health.ram_parity[1]) return SJA1105_RAM_PARITY_ERROR;
+    if (health.local_crc_error || health.global_crc_error) return SJA1105_CRC_ERROR;
+    if (health.action == SJA1105_HEALTH_RESET) return SJA1105_STATIC_CONF_ERROR;
+
+    return status;
+}
+
+
+sja1105_status_t SJA1105_ReadStatistics(sja1105_handle_t *dev, sja1105_statistics_t *stats) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         reg_data[SJA1105_NUM_PORTS * SJA1105_HIGH_LEVEL_STATS_SIZE];
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Get the statistics */
+    status = SJA1105_ReadRegister(dev, SJA1105_REG_HIGH_LEVEL_STATS_PORT0, reg_data, SJA1105_NUM_PORTS * SJA1105_HIGH_LEVEL_STATS_SIZE);
+    if (status != SJA1105_OK) goto end;
+
+    /* Store the relevent statistics in the output */
+    for (uint_fast8_t port = 0; port < SJA1105_NUM_PORTS; port++) {
+
+        /* Get the byte counters */
+        stats->tx_bytes[port]  = reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_TXBYTE_L];
+        stats->tx_bytes[port] |= (uint64_t) reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_TXBYTE_H] << 32;
+        stats->rx_bytes[port]  = reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_RXBYTE_L];
+        stats->rx_bytes[port] |= (uint64_t) reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_RXBYTE_H] << 32;
+
+        /* Get the frame counters */
+        stats->tx_frames[port]  = reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_TXFRM_L];
+        stats->tx_frames[port] |= (uint64_t) reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_TXFRM_H] << 32;
+        stats->rx_frames[port]  = reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_RXFRM_L];
+        stats->rx_frames[port] |= (uint64_t) reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_RXFRM_H] << 32;
+
+        /* Sum the dropped frame counter registers */
+        stats->dropped_frames[port] = 0;
+        for (uint_fast8_t err_reg = SJA1105_HIGH_LEVEL_STATS_N_POLERR; err_reg < SJA1105_HIGH_LEVEL_STATS_SIZE; err_reg++) {
+            stats->dropped_frames[port] += reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + err_reg];
+        }
+        stats->policed_frames[port] = reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_POLERR];
+    }
+
+    // status = SJA1105_ReadRegister(dev, 0x200, reg_data2, (0x01 + 0x01) * 5);
+    // if (status != SJA1105_OK) goto end;
+    // status = SJA1105_ReadRegister(dev, 0x600, reg_data2, (0x0b + 0x05) * 5);
+    // if (status != SJA1105_OK) goto end;
+    // status = SJA1105_ReadRegister(dev, 0x1400, reg_data2, (0x16 + 0x01) * 5);
+    // if (status != SJA1105_OK) goto end;
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Put a port to sleep to save power. Ingress and egress are disabled then the port's clocks are stopped (or the PCS is powered
+ * down for SGMII). The PLLs are left running, so SJA1105_PortWake() doesn't have to wait for them to lock. While the port
+ * is asleep speed changes and static config uploads keep its clocks stopped.
+ */
+sja1105_status_t SJA1105_PortSleep(sja1105_handle_t *dev, uint8_t port_num) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    sja1105_table_t *table   = &dev->tables.mac_configuration;
+    bool             ingress = false;
+    bool             egress  = false;
+    bool             written = false;
+
+    /* Parameter checking */
+    if (port_num >= SJA1105_NUM_PORTS) status = SJA1105_PARAMETER_ERROR;
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (dev->transaction.open) status = SJA1105_BUSY; /* The clocks are stopped immediately so this can't be deferred by a transaction */
+    if (status != SJA1105_OK) goto end;
+    if (dev->port_sleep.asleep & (1 << port_num)) goto end;
+
+    /* Save the forwarding state so it can be restored */
+    status = SJA1105_MACConfTableGetIngress(table, port_num, &ingress);
+    if (status != SJA1105_OK) goto end;
+    status = SJA1105_MACConfTableGetEgress(table, port_num, &egress);
+    if (status != SJA1105_OK) goto end;
+
+    /* Stop the MAC using the port before its clocks stop */
+    status = SJA1105_MACConfTableSetIngress(table, port_num, false);
+    if (status != SJA1105_OK) goto end;
+    status = SJA1105_MACConfTableSetEgress(table, port_num, false);
+    if (status != SJA1105_OK) goto end;
+    written = true;
+    status  = SJA1105_MACConfTableWrite(dev, port_num);
+    if (status != SJA1105_OK) goto end;
+
+    /* Stop the clocks */
+    dev->port_sleep.asleep |= 1 << port_num;
+    if (dev->config->ports[port_num].interface == SJA1105_INTERFACE_SGMII) {
+        status = SJA1105_SGMIISetSpeed(dev, dev->sgmii_speed);
+    } else {
+        status = SJA1105_CGUPortSetPowerDown(dev, port_num, true);
+    }
+    if (status != SJA1105_OK) {
+        dev->port_sleep.asleep &= ~(1 << port_num);
+        goto end;
+    }
+
+    /* Remember the forwarding state */
+    dev->port_sleep.ingress = (dev->port_sleep.ingress & ~(1 << port_num)) | (ingress << port_num);
+    dev->port_sleep.egress  = (dev->port_sleep.egress & ~(1 << port_num)) | (egress << port_num);
+    written                 = false;
+
+end:
+
+    /* If the clocks couldn't be stopped then restore the MAC */
+    if (written) {
+        SJA1105_MACConfTableSetIngress(table, port_num, ingress);
+        SJA1105_MACConfTableSetEgress(table, port_num, egress);
+        if (SJA1105_MACConfTableWrite(dev, port_num) != SJA1105_OK) status = SJA1105_REVERT_ERROR; /* Error while fixing an error! */
+    }
+
+    /* Give the mutex and return */
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Wake a port put to sleep by SJA1105_PortSleep(). The clocks are restarted from the CGU table then ingress and egress are
+ * restored to how they were before the port went to sleep.
+ */
+sja1105_status_t SJA1105_PortWake(sja1105_handle_t *dev, uint8_t port_num) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    sja1105_table_t *table = &dev->tables.mac_configuration;
+
+    /* Parameter checking */
+    if (port_num >= SJA1105_NUM_PORTS) status = SJA1105_PARAMETER_ERROR;
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (dev->transaction.open) status = SJA1105_BUSY;
+    if (status != SJA1105_OK) goto end;
+    if (!(dev->port_sleep.asleep & (1 << port_num))) goto end;
+
+    /* Restart the clocks */
+    dev->port_sleep.asleep &= ~(1 << port_num);
+    if (dev->config->ports[port_num].interface == SJA1105_INTERFACE_SGMII) {
+        status = SJA1105_SGMIISetSpeed(dev, dev->sgmii_speed);
+    } else {
+        status = SJA1105_CGUPortSetPowerDown(dev, port_num, false);
+    }
+    if (status != SJA1105_OK) {
+        dev->port_sleep.asleep |= 1 << port_num;
+        goto end;
+    }
+
+    /* Restore the MAC */
+    status = SJA1105_MACConfTableSetIngress(table, port_num, (dev->port_sleep.ingress & (1 << port_num)) != 0);
+    if (status != SJA1105_OK) goto end;
+    status = SJA1105_MACConfTableSetEgress(table, port_num, (dev->port_sleep.egress & (1 << port_num)) != 0);
+    if (status != SJA1105_OK) goto end;
+    status = SJA1105_MACConfTableWrite(dev, port_num);
+    if (status != SJA1105_OK) goto end;
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Set the function called by SJA1105_LinkMonitorPoll() when a port's state changes. Set callback to NULL to remove it. */
+sja1105_status_t SJA1105_LinkMonitorSetCallback(sja1105_handle_t *dev, uint8_t port_num, sja1105_callback_link_change_t callback, void *context) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (port_num >= SJA1105_NUM_PORTS) status = SJA1105_PARAMETER_ERROR;
     if (status != SJA1105_OK) goto end;
 
-    /* Get the temp (multiplied by 10). E.g. temp_x10 = 364 means 36.4 degrees */
-    /* Note that this is the lower end of the range, and the answer could be up to SJA1105_TS_LUT[guess + 1]*/
-    *temp_x10 = SJA1105_TS_LUT[guess];
+    dev->link_monitor.callbacks[port_num] = callback;
+    dev->link_monitor.contexts[port_num]  = context;
 
-/* Give the mutex and return */
+    /* Give the mutex and return */
 end:
     SJA1105_UNLOCK;
     return status;
 }
 
 
-sja1105_status_t SJA1105_ReadTemperature(sja1105_handle_t *dev, float *temp) {
-    int16_t          temperatureX10;
-    sja1105_status_t status = SJA1105_ReadTemperatureX10(dev, &temperatureX10);
-    *temp                   = (float) temperatureX10 / 10.0;
-    return status;
-}
-
-
-sja1105_status_t SJA1105_CheckStatusRegisters(sja1105_handle_t *dev) {
+/* Sample the state of every port and call the callbacks of the ports that changed since the last poll. The port status
+ * registers are read in one burst, with one more read of the PCS for the SGMII port. The PCS link flag latches low, so a link
+ * that dropped and recovered between polls is still reported. The first poll only takes a sample. If changed isn't NULL it is
+ * set to a mask of the ports that changed.
+ */
+sja1105_status_t SJA1105_LinkMonitorPoll(sja1105_handle_t *dev, uint8_t *changed) {
 
-    sja1105_status_t status = SJA1105_OK;
-    uint32_t         status_registers[SJA1105_REGULAR_CHECK_SIZE];
-    uint32_t         reg_data;
+    sja1105_status_t       status       = SJA1105_OK;
+    uint8_t                changed_mask = 0;
+    sja1105_port_status_t  new_status[SJA1105_NUM_PORTS];
+    sja1105_port_status_t  old_status[SJA1105_NUM_PORTS];
+    sja1105_port_status_t *last;
+    uint16_t               reg_data;
 
     /* Check the device is initialised and take the mutex */
     SJA1105_LOCK;
 
-    /* Read the status registers */
-    status = SJA1105_ReadRegister(dev, SJA1105_REGULAR_CHECK_ADDR, status_registers, SJA1105_REGULAR_CHECK_SIZE);
+    status = SJA1105_ACUReadPortStatus(dev, new_status);
     if (status != SJA1105_OK) goto end;
 
-    /* Check the virtual link status register */
-    reg_data = status_registers[SJA1105_REG_VL_PART_STATUS - SJA1105_REGULAR_CHECK_ADDR];
-    if (reg_data & (SJA1105_VLPARTS | SJA1105_VLROUTES)) {
-        uint32_t vlind    = (reg_data & SJA1105_VLPARIND_MASK) >> SJA1105_VLPARIND_SHIFT;
-        uint32_t vlparind = (reg_data & SJA1105_VLIND_SHIFT) >> SJA1105_VLIND_SHIFT;
+    /* Sleeping ports have no link */
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        if (dev->port_sleep.asleep & (1 << port_num)) new_status[port_num].link_up = false;
+    }
 
-        /* TODO: remove. virtual links haven't been implemented so this is an error */
-        UNUSED(vlind);
-        UNUSED(vlparind);
-        dev->events.spi_errors++;
-        return status;
+    /* Only the SGMII PCS knows the link state */
+    if (SJA1105_SGMIIInUse(dev) && new_status[SJA1105_SGMII_PORT].link_up) {
+        status = SJA1105_SGMIIRead(dev, SJA1105_SGMII_REG_BASIC_STATUS, &reg_data);
+        if (status != SJA1105_OK) goto end;
+        new_status[SJA1105_SGMII_PORT].link_up = (reg_data & SJA1105_SGMII_BASIC_STATUS_LINK) != 0;
     }
 
+    /* Find the changes and save the new sample */
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        last                 = &dev->link_monitor.status[port_num];
+        old_status[port_num] = *last;
+        *last                = new_status[port_num];
 
-    /* TODO: Check other registers */
+        if (!dev->link_monitor.sampled) continue;
+        if ((old_status[port_num].interface == last->interface) && (old_status[port_num].mode == last->mode) && (old_status[port_num].speed == last->speed) && (old_status[port_num].link_up == last->link_up)) continue;
 
+        changed_mask |= 1 << port_num;
+        dev->events.link_changes++;
+    }
+    dev->link_monitor.sampled = true;
 
-    /* Check for dropped frames due to forwarding or no free memory */
-    reg_data = status_registers[SJA1105_REG_GENERAL_STATUS_9 - SJA1105_REGULAR_CHECK_ADDR];
-    if (reg_data & (SJA1105_FWDS | SJA1105_PARTS)) {
+    /* Tell the callbacks once every port has been sampled, so a callback that reads another port's state gets the new one */
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        if (!(changed_mask & (1 << port_num)) || (dev->link_monitor.callbacks[port_num] == NULL)) continue;
+        dev->link_monitor.callbacks[port_num](dev, port_num, &old_status[port_num], &dev->link_monitor.status[port_num], dev->link_monitor.contexts[port_num]);
+    }
 
-        /* Extract the port number */
-        uint8_t port = (reg_data & SJA1105_FWDS_PARTS_PORT_MASK) >> SJA1105_FWDS_PARTS_PORT_SHIFT;
-        if (port >= SJA1105_NUM_PORTS) {
-            status = SJA1105_INVALID_VALUE_ERROR;
-            goto end;
-        }
+end:
+    if (changed != NULL) *changed = changed_mask;
+    SJA1105_UNLOCK;
+    return status;
+}
 
-        /* Increment the dropped frame counter */
-        dev->events.frames_dropped[port]++;
 
-        // TODO: Look at counter registers (0x400) to figure out the exact error
-    }
+/* Get the state of a port from the last SJA1105_LinkMonitorPoll() */
+sja1105_status_t SJA1105_LinkMonitorGetStatus(sja1105_handle_t *dev, uint8_t port_num, sja1105_port_status_t *port_status) {
 
-    /* Check for RAM parity errors */
-    if (status_registers[SJA1105_REG_GENERAL_STATUS_10 - SJA1105_REGULAR_CHECK_ADDR] || status_registers[SJA1105_REG_GENERAL_STATUS_11 - SJA1105_REGULAR_CHECK_ADDR]) {
-        status = SJA1105_RAM_PARITY_ERROR;
-        goto end;
-    }
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (port_num >= SJA1105_NUM_PORTS) status = SJA1105_PARAMETER_ERROR;
+    if (!dev->link_monitor.sampled) status = SJA1105_NOT_CONFIGURED_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    *port_status = dev->link_monitor.status[port_num];
 
     /* Give the mutex and return */
 end:
@@ -398,73 +1597,127 @@ end:
 }
 
 
-sja1105_status_t SJA1105_ReadStatistics(sja1105_handle_t *dev, sja1105_statistics_t *stats) {
+/* Read a register of the SGMII PCS, reg is the register's address within the PCS (e.g. 0x8000 for DIGITAL_CONTROL_1) */
+sja1105_status_t SJA1105_SGMIIReadRegister(sja1105_handle_t *dev, uint16_t reg, uint16_t *value) {
 
     sja1105_status_t status = SJA1105_OK;
-    uint32_t         reg_data[SJA1105_NUM_PORTS * SJA1105_HIGH_LEVEL_STATS_SIZE];
 
     /* Check the device is initialised and take the mutex */
     SJA1105_LOCK;
 
-    /* Get the statistics */
-    status = SJA1105_ReadRegister(dev, SJA1105_REG_HIGH_LEVEL_STATS_PORT0, reg_data, SJA1105_NUM_PORTS * SJA1105_HIGH_LEVEL_STATS_SIZE);
+    /* Parameter checking */
+    if (!SJA1105_SGMIIInUse(dev)) status = SJA1105_PARAMETER_ERROR;
     if (status != SJA1105_OK) goto end;
 
-    /* Store the relevent statistics in the output */
-    for (uint_fast8_t port = 0; port < SJA1105_NUM_PORTS; port++) {
+    status = SJA1105_SGMIIRead(dev, SJA1105_SGMII_REG_BASE + reg, value);
 
-        /* Get the byte counters */
-        stats->tx_bytes[port]  = reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_TXBYTE_L];
-        stats->tx_bytes[port] |= (uint64_t) reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_TXBYTE_H] << 32;
-        stats->rx_bytes[port]  = reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_RXBYTE_L];
-        stats->rx_bytes[port] |= (uint64_t) reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + SJA1105_HIGH_LEVEL_STATS_N_RXBYTE_H] << 32;
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
 
-        /* Sum the dropped frame counter registers */
-        stats->dropped_frames[port] = 0;
-        for (uint_fast8_t err_reg = SJA1105_HIGH_LEVEL_STATS_N_POLERR; err_reg < SJA1105_HIGH_LEVEL_STATS_SIZE; err_reg++) {
-            stats->dropped_frames[port] += reg_data[SJA1105_HIGH_LEVEL_STATS_PORT_OFFSET(port) + err_reg];
-        }
-    }
 
-    // status = SJA1105_ReadRegister(dev, 0x200, reg_data2, (0x01 + 0x01) * 5);
-    // if (status != SJA1105_OK) goto end;
-    // status = SJA1105_ReadRegister(dev, 0x600, reg_data2, (0x0b + 0x05) * 5);
-    // if (status != SJA1105_OK) goto end;
-    // status = SJA1105_ReadRegister(dev, 0x1400, reg_data2, (0x16 + 0x01) * 5);
-    // if (status != SJA1105_OK) goto end;
+/* Write a register of the SGMII PCS, reg is the register's address within the PCS. Note the registers are set up again after
+ * every static config upload, so changes to them may be lost.
+ */
+sja1105_status_t SJA1105_SGMIIWriteRegister(sja1105_handle_t *dev, uint16_t reg, uint16_t value) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (!SJA1105_SGMIIInUse(dev)) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    status = SJA1105_SGMIIWrite(dev, SJA1105_SGMII_REG_BASE + reg, value);
 
-    /* Give the mutex and return */
 end:
     SJA1105_UNLOCK;
     return status;
 }
 
 
-/* TODO: Disable transmitted clocks */
-sja1105_status_t SJA1105_PortSleep(sja1105_handle_t *dev, uint8_t port_num) {
+/* Get the state of the SGMII link. When autonegotiation is enabled the speed and duplex are the result of autonegotiation,
+ * which the PCS follows without any action from the driver.
+ */
+sja1105_status_t SJA1105_SGMIIGetStatus(sja1105_handle_t *dev, sja1105_sgmii_status_t *sgmii_status) {
 
-    sja1105_status_t status = SJA1105_NOT_IMPLEMENTED_ERROR;
+    sja1105_status_t status = SJA1105_OK;
+    uint16_t         reg_data;
 
     /* Check the device is initialised and take the mutex */
     SJA1105_LOCK;
 
+    /* Parameter checking */
+    if (!SJA1105_SGMIIInUse(dev)) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
 
-    /* Give the mutex and return */
+    /* With a forced speed only the link status is needed */
+    if (dev->sgmii_speed != SJA1105_SPEED_DYNAMIC) {
+        status = SJA1105_SGMIIRead(dev, SJA1105_SGMII_REG_BASIC_STATUS, &reg_data);
+        if (status != SJA1105_OK) goto end;
+
+        sgmii_status->link_up          = (reg_data & SJA1105_SGMII_BASIC_STATUS_LINK) != 0;
+        sgmii_status->autoneg_complete = false;
+        sgmii_status->full_duplex      = true;
+        sgmii_status->speed            = dev->sgmii_speed;
+        goto end;
+    }
+
+    /* Get the autonegotiation result */
+    status = SJA1105_SGMIIRead(dev, SJA1105_SGMII_REG_AUTONEG_INTR_STATUS, &reg_data);
+    if (status != SJA1105_OK) goto end;
+
+    sgmii_status->link_up          = (reg_data & SJA1105_SGMII_AUTONEG_STATUS_LINK) != 0;
+    sgmii_status->autoneg_complete = (reg_data & SJA1105_SGMII_AUTONEG_STATUS_COMPLETE) != 0;
+    sgmii_status->full_duplex      = (reg_data & SJA1105_SGMII_AUTONEG_STATUS_DUPLEX) != 0;
+    switch ((reg_data & SJA1105_SGMII_AUTONEG_STATUS_SPEED_MASK) >> SJA1105_SGMII_AUTONEG_STATUS_SPEED_SHIFT) {
+        case SJA1105_SGMII_AUTONEG_STATUS_SPEED_10M:
+            sgmii_status->speed = SJA1105_SPEED_10M;
+            break;
+        case SJA1105_SGMII_AUTONEG_STATUS_SPEED_100M:
+            sgmii_status->speed = SJA1105_SPEED_100M;
+            break;
+        case SJA1105_SGMII_AUTONEG_STATUS_SPEED_1G:
+            sgmii_status->speed = SJA1105_SPEED_1G;
+            break;
+        default:
+            sgmii_status->speed = SJA1105_SPEED_INVALID;
+            break;
+    }
+
+    /* The complete flag is sticky, clear it so the next completion can be seen */
+    if (sgmii_status->autoneg_complete) {
+        status = SJA1105_SGMIIWrite(dev, SJA1105_SGMII_REG_AUTONEG_INTR_STATUS, reg_data & ~SJA1105_SGMII_AUTONEG_STATUS_COMPLETE);
+        if (status != SJA1105_OK) goto end;
+    }
+
+end:
     SJA1105_UNLOCK;
     return status;
 }
 
 
-/* TODO: Enable transmitted clocks */
-sja1105_status_t SJA1105_PortWake(sja1105_handle_t *dev, uint8_t port_num) {
+/* Enable autonegotiation on the SGMII link, e.g. after SJA1105_PortSetSpeed() forced a speed. Only the PCS is changed so the
+ * other ports keep forwarding.
+ */
+sja1105_status_t SJA1105_SGMIIRestartAutoneg(sja1105_handle_t *dev) {
 
-    sja1105_status_t status = SJA1105_NOT_IMPLEMENTED_ERROR;
+    sja1105_status_t status = SJA1105_OK;
 
     /* Check the device is initialised and take the mutex */
     SJA1105_LOCK;
 
+    /* Parameter checking */
+    if (!SJA1105_SGMIIInUse(dev)) status = SJA1105_PARAMETER_ERROR;
+    if (dev->config->ports[SJA1105_SGMII_PORT].speed != SJA1105_SPEED_DYNAMIC) status = SJA1105_PARAMETER_ERROR; /* Only ports configured as dynamic can change speed */
+    if (status != SJA1105_OK) goto end;
+
+    status = SJA1105_SGMIISetSpeed(dev, SJA1105_SPEED_DYNAMIC);
 
-    /* Give the mutex and return */
+end:
     SJA1105_UNLOCK;
     return status;
 }
@@ -483,35 +1736,22 @@ sja1105_status_t SJA1105_L2EntryReadByIndex(sja1105_handle_t *dev, uint16_t inde
     if (status != SJA1105_OK) goto end;
 
     /* Initialise variables */
-    uint32_t reg_data[SJA1105_L2ADDR_LU_ENTRY_SIZE] = {0};
-
-    /* Wait for VALID to be 0. */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_L2_LUT_REG_0, SJA1105_DYN_CONF_L2_LUT_VALID, false);
-    if (status != SJA1105_OK) goto end;
+    uint32_t key[SJA1105_L2ADDR_LU_ENTRY_SIZE] = {0};
+    uint32_t command                           = 0;
 
-    /* Write the index to be read */
+    /* Create the index to be read */
     if (managment) {
-        reg_data[SJA1105_MGMT_INDEX_OFFSET] = ((uint32_t) index << SJA1105_MGMT_INDEX_SHIFT) & SJA1105_MGMT_INDEX_MASK;
+        key[SJA1105_MGMT_INDEX_OFFSET] = ((uint32_t) index << SJA1105_MGMT_INDEX_SHIFT) & SJA1105_MGMT_INDEX_MASK;
     } else {
-        reg_data[SJA1105_L2_LUT_INDEX_OFFSET] = ((uint32_t) index << SJA1105_L2_LUT_INDEX_SHIFT) & SJA1105_L2_LUT_INDEX_MASK;
+        key[SJA1105_L2_LUT_INDEX_OFFSET] = ((uint32_t) index << SJA1105_L2_LUT_INDEX_SHIFT) & SJA1105_L2_LUT_INDEX_MASK;
     }
-    status = SJA1105_WriteRegister(dev, SJA1105_DYN_CONF_L2_LUT_REG_1, reg_data, SJA1105_L2ADDR_LU_ENTRY_SIZE);
-    if (status != SJA1105_OK) goto end;
-
-    /* Write the read command */
-    reg_data[0]  = 0; /* Ensures RDRWSET is set to 0 (read) */
-    reg_data[0] |= SJA1105_DYN_CONF_L2_LUT_VALID;
-    if (managment) reg_data[0] |= SJA1105_DYN_CONF_L2_LUT_MGMTROUTE;
-    reg_data[0] |= ((uint32_t) SJA1105_L2_LUT_HOSTCMD_READ << SJA1105_L2_LUT_HOSTCMD_SHIFT) & SJA1105_L2_LUT_HOSTCMD_MASK;
-    status       = SJA1105_WriteRegister(dev, SJA1105_DYN_CONF_L2_LUT_REG_0, reg_data, 1);
-    if (status != SJA1105_OK) goto end;
 
-    /* Wait for VALID to be 0. */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_L2_LUT_REG_0, SJA1105_DYN_CONF_L2_LUT_VALID, false);
-    if (status != SJA1105_OK) goto end;
+    /* Create the read command */
+    if (managment) command |= SJA1105_DYN_CONF_L2_LUT_MGMTROUTE;
+    command |= ((uint32_t) SJA1105_L2_LUT_HOSTCMD_READ << SJA1105_L2_LUT_HOSTCMD_SHIFT) & SJA1105_L2_LUT_HOSTCMD_MASK;
 
-    /* Read the entry */
-    status = SJA1105_ReadRegister(dev, SJA1105_DYN_CONF_L2_LUT_REG_1, entry, SJA1105_L2ADDR_LU_ENTRY_SIZE);
+    /* Write the index and read command then read the entry */
+    status = SJA1105_DynConfRead(dev, &SJA1105_DYN_CONF_L2_LUT_DESC, command, key, entry);
     if (status != SJA1105_OK) goto end;
 
 end:
@@ -596,26 +1836,10 @@ sja1105_status_t SJA1105_ManagementRouteCreate(sja1105_handle_t *dev, const uint
     lut_entry[1] |= (uint32_t) dst_addr[5] << 30; /* [63:62] */
     lut_entry[2] |= (uint32_t) dst_addr[5] >> 2;  /* [69:64] */
 
-    /* Wait for VALID to be 0. */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_L2_LUT_REG_0, SJA1105_DYN_CONF_L2_LUT_VALID, false);
-    if (status != SJA1105_OK) goto end;
-
-    /* Write the entry */
-    status = SJA1105_WriteRegister(dev, SJA1105_DYN_CONF_L2_LUT_REG_1, lut_entry, SJA1105_L2ADDR_LU_ENTRY_SIZE);
-    if (status != SJA1105_OK) goto end;
-
-    /* Apply the entry */
-    reg_data  = SJA1105_DYN_CONF_L2_LUT_VALID;
-    reg_data |= SJA1105_DYN_CONF_L2_LUT_RDRWSET;
-    reg_data |= SJA1105_DYN_CONF_L2_LUT_MGMTROUTE;
+    /* Write and apply the entry, then check ERRORS */
+    reg_data  = SJA1105_DYN_CONF_L2_LUT_MGMTROUTE;
     reg_data |= ((uint32_t) SJA1105_L2_LUT_HOSTCMD_WRITE << SJA1105_L2_LUT_HOSTCMD_SHIFT) & SJA1105_L2_LUT_HOSTCMD_MASK;
-    status    = SJA1105_WriteRegister(dev, SJA1105_DYN_CONF_L2_LUT_REG_0, &reg_data, 1);
-    if (status != SJA1105_OK) goto end;
-
-    /* TODO: Possibly check ERRORS. It should only be set if VALID was 1 when the write started, which this function made sure it wasn't. */
-
-    /* Wait for VALID to be 0. */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_L2_LUT_REG_0, SJA1105_DYN_CONF_L2_LUT_VALID, false);
+    status    = SJA1105_DynConfWrite(dev, &SJA1105_DYN_CONF_L2_LUT_DESC, reg_data, lut_entry);
     if (status != SJA1105_OK) goto end;
 
     /* Update the device struct */
@@ -742,27 +1966,295 @@ end:
 }
 
 
-/* Read current table data from the SJA1105 into the device struct. Can be used to ensure shadow tables are the same */
+/* Read current table data from the SJA1105 into the device struct. Can be used to ensure shadow tables are the same.
+ * Entries with changes that haven't been written yet are skipped so they aren't lost. The L2 policing table has no dynamic
+ * reconfiguration interface and the credit based shaping table's can only be written, so neither is read.
+ */
 sja1105_status_t SJA1105_ReadAllTables(sja1105_handle_t *dev) {
 
-    sja1105_status_t status = SJA1105_NOT_IMPLEMENTED_ERROR;
+    sja1105_status_t status     = SJA1105_OK;
+    uint32_t         start_time = 0;
 
     /* Check the device is initialised and take the mutex */
     SJA1105_LOCK;
 
-    /* Read all the MAC config table entries */
-    for (uint_fast8_t i = 0; i < SJA1105_NUM_PORTS; i++) {
-        status = SJA1105_MACConfTableRead(dev, i);
+    /* Reading would overwrite entries changed in the open transaction */
+    if (dev->transaction.open) status = SJA1105_BUSY;
+    if (status != SJA1105_OK) goto end;
+
+    /* Read every table that is in use */
+    start_time = dev->callbacks->callback_get_time_ms(dev);
+    for (uint_fast8_t i = 0; i < SJA1105_DYN_TABLE_NUM_READABLE; i++) {
+        status = SJA1105_DynTableReadRange(dev, SJA1105_DYN_TABLE_READ_ORDER[i], 0, UINT32_MAX, false, NULL);
         if (status != SJA1105_OK) goto end;
     }
 
-    /* Read all the L2 forwarding table entries */
-    for (uint_fast8_t i = 0; i < SJA1105_STATIC_CONF_L2_FORWARDING_NUM_ENTRIES; i++) {
-        status = SJA1105_L2ForwardingTableRead(dev, i);
+    /* Record how long the readback took */
+    dev->events.readback_time_ms = dev->callbacks->callback_get_time_ms(dev) - start_time;
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Compare up to budget table entries on the device against the shadow tables, continuing from where the previous call stopped
+ * and wrapping around after the last table. Call this periodically to find entries that have drifted (e.g. from a bit flip)
+ * before they cause a parity error. Entries of dynamically writable tables that differ are rewritten from the shadow tables.
+ * Differences in other tables are only counted in events.scrub_mismatches, SJA1105_SyncStaticConfig() can be used to repair them.
+ */
+sja1105_status_t SJA1105_Scrub(sja1105_handle_t *dev, uint16_t budget) {
+
+    sja1105_status_t    status   = SJA1105_OK;
+    sja1105_scrubber_t *scrubber = &dev->scrubber;
+    uint32_t            num_entries;
+    uint32_t            checked;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Entries changed in the open transaction would be reported as drift */
+    if (dev->transaction.open) status = SJA1105_BUSY;
+    if (status != SJA1105_OK) goto end;
+
+    /* Visit each table at most once more than the number of tables, so empty tables can't cause an infinite loop */
+    for (uint_fast8_t i = 0; (budget > 0) && (i <= SJA1105_DYN_TABLE_NUM_READABLE); i++) {
+
+        /* Check the next part of the current table */
+        status = SJA1105_DynTableReadRange(dev, SJA1105_DYN_TABLE_READ_ORDER[scrubber->table], scrubber->entry, budget, true, &num_entries);
         if (status != SJA1105_OK) goto end;
+
+        /* Move to the next table if the end of this one was reached */
+        checked = (scrubber->entry < num_entries) ? CONSTRAIN(num_entries - scrubber->entry, 0, budget) : 0;
+        budget          -= checked;
+        scrubber->entry += checked;
+        if (scrubber->entry >= num_entries) {
+            scrubber->entry = 0;
+            scrubber->table = (scrubber->table + 1) % SJA1105_DYN_TABLE_NUM_READABLE;
+        }
+    }
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+/* Recover from a RAM parity error. The parity registers say which memories are corrupt, and if every one of them holds a
+ * dynamically writable table those tables are compared against the shadow tables and the corrupt entries rewritten, so the
+ * switch is never reset. Otherwise (e.g. the error was in the L2 address lookup table, whose learned entries aren't in the
+ * shadow table, or in frame memory) the static configuration is reloaded with SJA1105_SyncStaticConfig(). The parity
+ * registers stay set until the next reset, so repaired memories are remembered and ignored by SJA1105_HealthCheck().
+ * reloaded is set to true if the static configuration was reloaded. The time taken by each path is recorded in the event
+ * counters.
+ */
+sja1105_status_t SJA1105_ParityRecover(sja1105_handle_t *dev, bool *reloaded) {
+
+    sja1105_status_t status     = SJA1105_OK;
+    uint32_t         start_time = 0;
+    uint32_t         mismatches = 0;
+    uint32_t         repairs    = 0;
+    uint32_t         parity[2];
+    uint64_t         memories;
+    uint64_t         unclaimed;
+    sja1105_table_t *table;
+    bool             repaired = false;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    *reloaded = false;
+
+    /* Entries changed in the open transaction would be reported as corrupt */
+    if (dev->transaction.open) status = SJA1105_BUSY;
+    if (status != SJA1105_OK) goto end;
+
+    /* Nothing to do without a new parity error */
+    status = SJA1105_ReadRegister(dev, SJA1105_REG_GENERAL_STATUS_10, parity, 2);
+    if (status != SJA1105_OK) goto end;
+    memories = SJA1105_RAM_PARITY_MEMORIES(parity[0], parity[1]) & ~dev->ram_parity_repaired;
+    if (memories == 0) goto end;
+
+    /* Only try a targeted repair if every corrupt memory holds a table that can be rewritten */
+    start_time = dev->callbacks->callback_get_time_ms(dev);
+    unclaimed  = memories;
+    repaired   = true;
+    for (uint_fast8_t block_id = 0; block_id <= SJA1105_BLOCK_ID_SGMII_CONF; block_id++) {
+        if ((memories & SJA1105_RAM_PARITY_MEMORY_LUT[block_id]) == 0) continue;
+        unclaimed &= ~SJA1105_RAM_PARITY_MEMORY_LUT[block_id];
+        table      = SJA1105_GetTable(dev, block_id);
+        if ((table == NULL) || !table->in_use || !SJA1105_DynTableIsWritable(block_id)) repaired = false;
+    }
+    if (unclaimed != 0) repaired = false;
+
+    /* Find and rewrite the corrupt entries of the affected tables. A failed read is treated as an unrepairable table */
+    mismatches = dev->events.scrub_mismatches;
+    repairs    = dev->events.scrub_repairs;
+    for (uint_fast8_t block_id = 0; repaired && (block_id <= SJA1105_BLOCK_ID_SGMII_CONF); block_id++) {
+        if ((memories & SJA1105_RAM_PARITY_MEMORY_LUT[block_id]) == 0) continue;
+        if (SJA1105_DynTableReadRange(dev, block_id, 0, UINT32_MAX, true, NULL) != SJA1105_OK) repaired = false;
+    }
+
+    /* Only trust the repair if something was found and everything found was rewritten */
+    mismatches = dev->events.scrub_mismatches - mismatches;
+    repairs    = dev->events.scrub_repairs - repairs;
+    if ((mismatches == 0) || (repairs != mismatches)) repaired = false;
+    dev->events.parity_repair_time_ms = dev->callbacks->callback_get_time_ms(dev) - start_time;
+
+    if (repaired) {
+        dev->ram_parity_repaired |= memories;
+        dev->events.parity_repairs++;
+        goto end;
+    }
+
+    /* Fall back to reloading everything */
+    start_time = dev->callbacks->callback_get_time_ms(dev);
+    status     = SJA1105_SyncStaticConfig(dev);
+    if (status != SJA1105_OK) goto end;
+    dev->events.parity_reload_time_ms = dev->callbacks->callback_get_time_ms(dev) - start_time;
+    dev->events.parity_reloads++;
+    *reloaded = true;
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Check whether an entry in a table has been changed but not yet written to the device */
+sja1105_status_t SJA1105_TableGetDirty(sja1105_handle_t *dev, uint8_t block_id, uint16_t index, bool *dirty) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    sja1105_table_t *table = SJA1105_GetTable(dev, block_id);
+
+    /* Argument checking */
+    if (table == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (index >= SJA1105_GET_TABLE_MAX_ENTRIES(block_id)) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    *dirty = SJA1105_TableIsDirty(table, index);
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Get the number of entries in a table that have been changed but not yet written to the device */
+sja1105_status_t SJA1105_TableCountDirty(sja1105_handle_t *dev, uint8_t block_id, uint32_t *count) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    sja1105_table_t *table = SJA1105_GetTable(dev, block_id);
+
+    /* Argument checking */
+    if (table == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    *count = SJA1105_TableCountDirtyEntries(table);
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Mark every entry in a table as matching the device without writing anything. Only use this if the device is known to
+ * match the shadow table through some other means.
+ */
+sja1105_status_t SJA1105_TableClearDirty(sja1105_handle_t *dev, uint8_t block_id) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    sja1105_table_t *table = SJA1105_GetTable(dev, block_id);
+
+    /* Argument checking */
+    if (table == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    SJA1105_TableMarkAllClean(table);
+
+    /* Give the mutex and return */
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Write every changed entry to the device. If all the changed entries belong to tables that support dynamic
+ * reconfiguration then only those entries are written, otherwise the whole static config is uploaded instead.
+ */
+sja1105_status_t SJA1105_SyncDirty(sja1105_handle_t *dev) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    sja1105_table_t *table;
+    uint16_t         indices[SJA1105_DYN_CONF_MAX_BATCH];
+    uint32_t         count       = 0;
+    bool             full_upload = false;
+
+    /* A static config upload can't be deferred by a transaction */
+    if (dev->transaction.open) status = SJA1105_BUSY;
+    if (status != SJA1105_OK) goto end;
+
+    /* Check if any changes can only be applied by uploading the static config */
+    for (uint_fast8_t i = 0; i < SJA1105_NUM_TABLES; i++) {
+        table = &dev->tables.by_index[i];
+        if (!table->in_use || (SJA1105_TableCountDirtyEntries(table) == 0)) continue;
+        if (!SJA1105_DynTableIsWritable(*table->id)) full_upload = true;
     }
 
-    // TODO: Add more tables
+    /* Upload the static config, this also marks every table as clean */
+    if (full_upload) {
+        status = SJA1105_SyncStaticConfig(dev);
+        goto end;
+    }
+
+    /* Write the changed entries of each table in batches */
+    for (uint_fast8_t i = 0; i < SJA1105_NUM_TABLES; i++) {
+        table = &dev->tables.by_index[i];
+        if (!table->in_use) continue;
+
+        count = 0;
+        for (uint_fast16_t index = 0; index < SJA1105_GET_TABLE_MAX_ENTRIES(*table->id); index++) {
+            if (!SJA1105_TableIsDirty(table, index)) continue;
+            indices[count++] = index;
+
+            /* Write a full batch */
+            if (count == SJA1105_DYN_CONF_MAX_BATCH) {
+                status = SJA1105_DynTableWriteEntries(dev, *table->id, indices, count);
+                if (status != SJA1105_OK) goto end;
+                count = 0;
+            }
+        }
+
+        /* Write the remaining entries */
+        status = SJA1105_DynTableWriteEntries(dev, *table->id, indices, count);
+        if (status != SJA1105_OK) goto end;
+    }
 
     /* Give the mutex and return */
 end:
@@ -9,6 +9,7 @@
 #include "internal/sja1105_conf.h"
 #include "internal/sja1105_io.h"
 #include "internal/sja1105_regs.h"
+#include "internal/sja1105_tables.h"
 
 
 static const uint32_t sja1105_acu_block_default[SJA1105_ACU_BLOCK_SIZE] = {
@@ -58,7 +59,7 @@ sja1105_status_t SJA1105_ConfigureACU(sja1105_handle_t *dev, bool write) {
 
     /* TODO: Configure MISC, SPI, and JTAG IO pads. */
 
-    /* No need to configure the temperature sensor since that is done when the temperature sensor is read */
+    /* No need to configure the temperature sensor since it is enabled in the table when it is first read */
 
     return status;
 }
@@ -165,11 +166,8 @@ sja1105_status_t SJA1105_ConfigureACUPort(sja1105_handle_t *dev, uint8_t port_nu
     }
 
     /* Update the internal copy of the table */
-    if (dev->tables.acu_config_parameters.in_use) {
-        dev->tables.acu_config_parameters.data[SJA1105_ACU_TABLE_PAD_MIIX_TX_INDEX(port_num)] = reg_data[SJA1105_ACU_PAD_CFG_TX];
-        dev->tables.acu_config_parameters.data[SJA1105_ACU_TABLE_PAD_MIIX_RX_INDEX(port_num)] = reg_data[SJA1105_ACU_PAD_CFG_RX];
-        dev->tables.acu_config_parameters.data_crc_valid                                      = false;
-    }
+    SJA1105_TableSetWord(&dev->tables.acu_config_parameters, SJA1105_ACU_TABLE_PAD_MIIX_TX_INDEX(port_num), reg_data[SJA1105_ACU_PAD_CFG_TX]);
+    SJA1105_TableSetWord(&dev->tables.acu_config_parameters, SJA1105_ACU_TABLE_PAD_MIIX_RX_INDEX(port_num), reg_data[SJA1105_ACU_PAD_CFG_RX]);
 
     /* TODO: Update the internal delay (ID) register (SJA1105_ACU_REG_CFG_PAD_MIIX_ID) if internal RGMII
      *       CLK delays are needed. Many PHYs also implement this and it is only needed once per TX or RX
@@ -179,3 +177,23 @@ sja1105_status_t SJA1105_ConfigureACUPort(sja1105_handle_t *dev, uint8_t port_nu
 
     return status;
 }
+
+
+/* Read the status of every port in a single burst. The link state isn't reported by the ACU so link_up is left as true. */
+sja1105_status_t SJA1105_ACUReadPortStatus(sja1105_handle_t *dev, sja1105_port_status_t port_status[SJA1105_NUM_PORTS]) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         reg_data[SJA1105_NUM_PORTS];
+
+    status = SJA1105_ReadRegister(dev, SJA1105_ACU_REG_PORT_STATUS_MII0, reg_data, SJA1105_NUM_PORTS);
+    if (status != SJA1105_OK) return status;
+
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        port_status[port_num].interface = (reg_data[port_num] & SJA1105_ACU_PORT_STATUS_XMII_MODE_MASK) >> SJA1105_ACU_PORT_STATUS_XMII_MODE_SHIFT;
+        port_status[port_num].mode      = (reg_data[port_num] & SJA1105_ACU_PORT_STATUS_PHY_MODE) ? SJA1105_MODE_PHY : SJA1105_MODE_MAC;
+        port_status[port_num].speed     = (reg_data[port_num] & SJA1105_ACU_PORT_STATUS_SPEED_MASK) >> SJA1105_ACU_PORT_STATUS_SPEED_SHIFT;
+        port_status[port_num].link_up   = true;
+    }
+
+    return status;
+}
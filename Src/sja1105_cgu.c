@@ -9,6 +9,7 @@
 #include "internal/sja1105_conf.h"
 #include "internal/sja1105_io.h"
 #include "internal/sja1105_regs.h"
+#include "internal/sja1105_tables.h"
 
 
 /* TODO: Fill in the non-reserved register defaults (this is low priority since all values are written in SJA1105_ConfigureCGU()) */
@@ -94,7 +95,7 @@ sja1105_status_t SJA1105_ConfigureCGU(sja1105_handle_t *dev, bool write) {
 
 
     /* Save the PLL0 configuration */
-    if (dev->tables.cgu_config_parameters.in_use) dev->tables.cgu_config_parameters.data[SJA1105_CGU_TABLE_PLL_0_C_INDEX] = reg_data;
+    SJA1105_TableSetWord(&dev->tables.cgu_config_parameters, SJA1105_CGU_TABLE_PLL_0_C_INDEX, reg_data);
 
     /* Setup PLL1 (f = 50MHz, integer mode) */
     reg_data  = 0;
@@ -124,7 +125,7 @@ sja1105_status_t SJA1105_ConfigureCGU(sja1105_handle_t *dev, bool write) {
     }
 
     /* Save the PLL1 configuration */
-    if (dev->tables.cgu_config_parameters.in_use) dev->tables.cgu_config_parameters.data[SJA1105_CGU_TABLE_PLL_1_C_INDEX] = reg_data;
+    SJA1105_TableSetWord(&dev->tables.cgu_config_parameters, SJA1105_CGU_TABLE_PLL_1_C_INDEX, reg_data);
 
     /* Configure each port */
     for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
@@ -135,6 +136,30 @@ sja1105_status_t SJA1105_ConfigureCGU(sja1105_handle_t *dev, bool write) {
     return status;
 }
 
+/* Write a port's IDIV and CLK registers. If power_down is set every one of them is written with PD set, which stops the clocks
+ * without losing their sources so they can be restarted quickly. The PLLs are shared so they are never stopped.
+ */
+static sja1105_status_t SJA1105_CGUPortWriteRegisters(sja1105_handle_t *dev, uint8_t port_num, uint32_t idiv_data, const uint32_t clk_data[SJA1105_CGU_REG_CLK_NUM], bool power_down) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         reg_data[SJA1105_CGU_REG_CLK_NUM];
+
+    /* Write to the IDIV register */
+    if (power_down) idiv_data |= SJA1105_CGU_PD;
+    status = SJA1105_WriteRegister(dev, SJA1105_CGU_REG_IDIV_C(port_num), &idiv_data, 1);
+    if (status != SJA1105_OK) return status;
+
+    /* Write to the CLK registers */
+    for (uint_fast8_t i = 0; i < SJA1105_CGU_REG_CLK_NUM; i++) {
+        reg_data[i] = clk_data[i] | (power_down ? SJA1105_CGU_PD : 0);
+    }
+    status = SJA1105_WriteRegister(dev, SJA1105_CGU_REG_CLK_BASE(port_num), reg_data, SJA1105_CGU_REG_CLK_NUM);
+    if (status != SJA1105_OK) return status;
+
+    return status;
+}
+
+
 sja1105_status_t SJA1105_ConfigureCGUPort(sja1105_handle_t *dev, uint8_t port_num, bool write) {
 
     sja1105_status_t      status                            = SJA1105_OK;
@@ -358,29 +383,48 @@ sja1105_status_t SJA1105_ConfigureCGUPort(sja1105_handle_t *dev, uint8_t port_nu
     /* Apply the configuration to non-sgmii ports */
     if (port->interface != SJA1105_INTERFACE_SGMII) {
 
-        /* Write the configuration */
+        /* Write the configuration. The clocks of a sleeping port are kept stopped until it is woken */
         if (write) {
-
-            /* Write to the IDIV register */
-            status = SJA1105_WriteRegister(dev, SJA1105_CGU_REG_IDIV_C(port_num), &idiv_data, 1);
-            if (status != SJA1105_OK) return status;
-
-            /* Write to the CLK registers */
-            status = SJA1105_WriteRegister(dev, SJA1105_CGU_REG_CLK_BASE(port_num), clk_data, SJA1105_CGU_REG_CLK_NUM);
+            status = SJA1105_CGUPortWriteRegisters(dev, port_num, idiv_data, clk_data, (dev->port_sleep.asleep & (1 << port_num)) != 0);
             if (status != SJA1105_OK) return status;
         }
 
         /* Update the internal table */
-        if (dev->tables.cgu_config_parameters.in_use) {
-            dev->tables.cgu_config_parameters.data[SJA1105_CGU_TABLE_IDIV_X_C_INDEX(port_num)]            = idiv_data;
-            dev->tables.cgu_config_parameters.data[SJA1105_CGU_TABLE_MIIX_MII_TX_CLK_C_INDEX(port_num)]   = clk_data[SJA1105_CGU_MII_TX_CLK];
-            dev->tables.cgu_config_parameters.data[SJA1105_CGU_TABLE_MIIX_MII_RX_CLK_C_INDEX(port_num)]   = clk_data[SJA1105_CGU_MII_RX_CLK];
-            dev->tables.cgu_config_parameters.data[SJA1105_CGU_TABLE_MIIX_RMII_REF_CLK_C_INDEX(port_num)] = clk_data[SJA1105_CGU_RMII_REF_CLK];
-            dev->tables.cgu_config_parameters.data[SJA1105_CGU_TABLE_MIIX_RGMII_TX_CLK_CINDEX(port_num)]  = clk_data[SJA1105_CGU_RGMII_TX_CLK];
-            dev->tables.cgu_config_parameters.data[SJA1105_CGU_TABLE_MIIX_EXT_TX_CLK_C_INDEX(port_num)]   = clk_data[SJA1105_CGU_EXT_TX_CLK];
-            dev->tables.cgu_config_parameters.data[SJA1105_CGU_TABLE_MIIX_EXT_RX_CLK_C_INDEX(port_num)]   = clk_data[SJA1105_CGU_EXT_RX_CLK];
-        }
+        SJA1105_TableSetWord(&dev->tables.cgu_config_parameters, SJA1105_CGU_TABLE_IDIV_X_C_INDEX(port_num), idiv_data);
+        SJA1105_TableSetWord(&dev->tables.cgu_config_parameters, SJA1105_CGU_TABLE_MIIX_MII_TX_CLK_C_INDEX(port_num), clk_data[SJA1105_CGU_MII_TX_CLK]);
+        SJA1105_TableSetWord(&dev->tables.cgu_config_parameters, SJA1105_CGU_TABLE_MIIX_MII_RX_CLK_C_INDEX(port_num), clk_data[SJA1105_CGU_MII_RX_CLK]);
+        SJA1105_TableSetWord(&dev->tables.cgu_config_parameters, SJA1105_CGU_TABLE_MIIX_RMII_REF_CLK_C_INDEX(port_num), clk_data[SJA1105_CGU_RMII_REF_CLK]);
+        SJA1105_TableSetWord(&dev->tables.cgu_config_parameters, SJA1105_CGU_TABLE_MIIX_RGMII_TX_CLK_CINDEX(port_num), clk_data[SJA1105_CGU_RGMII_TX_CLK]);
+        SJA1105_TableSetWord(&dev->tables.cgu_config_parameters, SJA1105_CGU_TABLE_MIIX_EXT_TX_CLK_C_INDEX(port_num), clk_data[SJA1105_CGU_EXT_TX_CLK]);
+        SJA1105_TableSetWord(&dev->tables.cgu_config_parameters, SJA1105_CGU_TABLE_MIIX_EXT_RX_CLK_C_INDEX(port_num), clk_data[SJA1105_CGU_EXT_RX_CLK]);
     }
 
     return status;
 }
+
+
+/* Stop or restart a port's clocks using the configuration in the CGU table, e.g. when the port is put to sleep */
+sja1105_status_t SJA1105_CGUPortSetPowerDown(sja1105_handle_t *dev, uint8_t port_num, bool power_down) {
+
+    sja1105_status_t       status = SJA1105_OK;
+    const sja1105_table_t *table  = &dev->tables.cgu_config_parameters;
+    uint32_t               clk_data[SJA1105_CGU_REG_CLK_NUM];
+
+    /* Skip port 4 in variants that don't have one (due to SGMII) */
+    if (((dev->config->variant == VARIANT_SJA1105R) || (dev->config->variant == VARIANT_SJA1105S)) && (port_num == 4)) return status;
+    if (dev->config->ports[port_num].interface == SJA1105_INTERFACE_SGMII) return status;
+
+    /* Parameter checking */
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Get the clock configuration from the table */
+    clk_data[SJA1105_CGU_MII_TX_CLK]   = table->data[SJA1105_CGU_TABLE_MIIX_MII_TX_CLK_C_INDEX(port_num)];
+    clk_data[SJA1105_CGU_MII_RX_CLK]   = table->data[SJA1105_CGU_TABLE_MIIX_MII_RX_CLK_C_INDEX(port_num)];
+    clk_data[SJA1105_CGU_RMII_REF_CLK] = table->data[SJA1105_CGU_TABLE_MIIX_RMII_REF_CLK_C_INDEX(port_num)];
+    clk_data[SJA1105_CGU_RGMII_TX_CLK] = table->data[SJA1105_CGU_TABLE_MIIX_RGMII_TX_CLK_CINDEX(port_num)];
+    clk_data[SJA1105_CGU_EXT_TX_CLK]   = table->data[SJA1105_CGU_TABLE_MIIX_EXT_TX_CLK_C_INDEX(port_num)];
+    clk_data[SJA1105_CGU_EXT_RX_CLK]   = table->data[SJA1105_CGU_TABLE_MIIX_EXT_RX_CLK_C_INDEX(port_num)];
+
+    return SJA1105_CGUPortWriteRegisters(dev, port_num, table->data[SJA1105_CGU_TABLE_IDIV_X_C_INDEX(port_num)], clk_data, power_down);
+}
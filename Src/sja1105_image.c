@@ -0,0 +1,241 @@
+/*
+ * sja1105_image.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bens1
+ */
+
+#include "memory.h"
+
+#include "sja1105.h"
+#include "internal/sja1105_conf.h"
+#include "internal/sja1105_tables.h"
+#include "internal/sja1105_regs.h"
+
+
+/* Accumulate words into a CRC32 (Ethernet polynomial, the same CRC the switch uses). Each word is fed in least significant
+ * byte first. Start with SJA1105_CRC32_INIT, the CRC is the bitwise inverse of the final state. Intended for
+ * callback_crc_accumulate on hosts without a CRC peripheral.
+ */
+uint32_t SJA1105_CRC32Update(uint32_t state, const uint32_t *data, uint32_t size) {
+
+    uint32_t word;
+
+    for (uint32_t i = 0; i < size; i++) {
+        word = data[i];
+        for (uint_fast8_t byte = 0; byte < 4; byte++) {
+            state ^= word & 0xff;
+            word  >>= 8;
+            for (uint_fast8_t bit = 0; bit < 8; bit++) {
+                state = (state >> 1) ^ ((state & 1) ? 0xedb88320 : 0);
+            }
+        }
+    }
+
+    return state;
+}
+
+
+/* Number of zero words starting at image[start], up to the longest run a control word can hold */
+static uint32_t SJA1105_ImageZeroRun(const uint32_t *image, uint32_t start, uint32_t size) {
+
+    uint32_t end = start;
+
+    while ((end < size) && (image[end] == 0) && ((end - start) < SJA1105_RLE_COUNT_MASK)) end++;
+
+    return end - start;
+}
+
+
+/* Compress a static configuration image for SJA1105_LoaderFeedCompressed(). The image is split into runs, each starting with
+ * a control word: runs of zeros (long enough to save space) are just the control word with SJA1105_RLE_ZEROS set, anything
+ * else is copied after its control word. The variable length tables are mostly zeros so they compress well, and no CRCs
+ * are needed to decompress since the loader checks the blocks themselves.
+ */
+sja1105_status_t SJA1105_ImageCompress(const uint32_t *image, uint32_t size, uint32_t *compressed, uint32_t capacity, uint32_t *compressed_size) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         in     = 0;
+    uint32_t         out    = 0;
+    uint32_t         start  = 0;
+    uint32_t         count  = 0;
+
+    /* Check parameters */
+    if ((image == NULL) || (compressed == NULL) || (compressed_size == NULL)) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    while (in < size) {
+
+        /* A run of zeros shorter than this costs more to split a literal run for than it saves */
+        count = SJA1105_ImageZeroRun(image, in, size);
+        if (count >= SJA1105_RLE_MIN_ZEROS) {
+            if ((out + 1) > capacity) status = SJA1105_PARAMETER_ERROR;
+            if (status != SJA1105_OK) return status;
+            compressed[out++]  = SJA1105_RLE_ZEROS | count;
+            in                += count;
+            continue;
+        }
+
+        /* Copy everything up to the next long run of zeros */
+        start = in;
+        while ((in < size) && ((in - start) < SJA1105_RLE_COUNT_MASK) && (SJA1105_ImageZeroRun(image, in, size) < SJA1105_RLE_MIN_ZEROS)) in++;
+        count = in - start;
+
+        if ((out + 1 + count) > capacity) status = SJA1105_PARAMETER_ERROR;
+        if (status != SJA1105_OK) return status;
+        compressed[out++] = count;
+        memcpy(compressed + out, image + start, count * sizeof(uint32_t));
+        out += count;
+    }
+
+    *compressed_size = out;
+
+    return status;
+}
+
+
+/* Check a static configuration image the same way SJA1105_Init() does (block structure, CRCs, every table's size and fields,
+ * and the fields that depend on other tables) without touching the device, so a bad image can be rejected before the switch
+ * is reset. Only the allocation and CRC callbacks are used, so this can also be run on the build host.
+ */
+sja1105_status_t SJA1105_ImageValidate(const sja1105_config_t *config, const sja1105_callbacks_t *callbacks, const uint32_t *static_conf, uint32_t static_conf_size) {
+
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_handle_t dev;
+    uint32_t         fixed_length_buffer[SJA1105_FIXED_BUFFER_SIZE];
+
+    /* Check parameters */
+    if (static_conf == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (callbacks->callback_allocate == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (callbacks->callback_free == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (callbacks->callback_crc_reset == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (callbacks->callback_crc_accumulate == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Load the image into a local handle that only ever holds the tables */
+    memset(&dev, 0, sizeof(dev));
+    dev.config    = config;
+    dev.callbacks = callbacks;
+    SJA1105_ResetTables(&dev, fixed_length_buffer);
+
+    status = SJA1105_LoadStaticConfig(&dev, static_conf, static_conf_size);
+
+    if (status == SJA1105_OK) {
+        status = SJA1105_FreeAllTableMemory(&dev);
+    } else {
+        SJA1105_FreeAllTableMemory(&dev);
+    }
+
+    return status;
+}
+
+
+/* Build a complete static configuration image from a base image with the VLANs, policers and forwarding in spec applied.
+ * Every header, data and global CRC in the image is calculated here, so a device given the image with
+ * sja1105_config_t.trust_crcs set doesn't need to calculate any CRCs when loading or uploading it. Nothing is written to
+ * the device, only the allocation and CRC callbacks are used, so this can be run on the build host.
+ *
+ * The base image provides every table the driver has no packer for (general, L2 lookup and AVB parameters, the MAC
+ * configuration's queue partitions and the pad settings of the clock and auxiliary units), so the values the board was
+ * designed with aren't replaced by guesses. The ports are checked against config->ports when the base image is loaded,
+ * so a base image made for other ports is rejected with SJA1105_STATIC_CONF_ERROR.
+ */
+sja1105_status_t SJA1105_ImageBuild(const sja1105_config_t *config, const sja1105_callbacks_t *callbacks, const sja1105_image_spec_t *spec, uint32_t *image, uint32_t capacity, uint32_t *size) {
+
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_handle_t dev;
+    uint32_t         fixed_length_buffer[SJA1105_FIXED_BUFFER_SIZE];
+    uint32_t         entry[SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE];
+    uint32_t        *shadow;
+    uint16_t         num_new = 0;
+
+    /* Check parameters */
+    if ((spec->base == NULL) || (image == NULL) || (size == NULL)) status = SJA1105_PARAMETER_ERROR;
+    if ((spec->num_vlans > 0) && (spec->vlans == NULL)) status = SJA1105_PARAMETER_ERROR;
+    if ((spec->num_policers > 0) && (spec->policers == NULL)) status = SJA1105_PARAMETER_ERROR;
+    if (callbacks->callback_allocate == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (callbacks->callback_free == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (callbacks->callback_crc_reset == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (callbacks->callback_crc_accumulate == NULL) status = SJA1105_PARAMETER_ERROR;
+    for (uint_fast16_t i = 0; i < spec->num_vlans; i++) {
+        if (spec->vlans[i].vid >= SJA1105_NUM_VLAN_IDS) status = SJA1105_PARAMETER_ERROR;
+    }
+    if (status != SJA1105_OK) return status;
+
+    /* Use a local handle that only ever holds the tables */
+    memset(&dev, 0, sizeof(dev));
+    dev.config    = config;
+    dev.callbacks = callbacks;
+    SJA1105_ResetTables(&dev, fixed_length_buffer);
+
+    /* Load the base image */
+    status = SJA1105_LoadStaticConfig(&dev, spec->base, spec->base_size);
+    if (status != SJA1105_OK) goto end;
+
+    /* Add or replace the VLANs */
+    if (spec->num_vlans > 0) {
+        if (!dev.tables.vlan_lookup.in_use) status = SJA1105_MISSING_TABLE_ERROR;
+        if (status != SJA1105_OK) goto end;
+
+        for (uint_fast16_t i = 0; i < spec->num_vlans; i++) {
+            if (!SJA1105_VLANIsPresent(&dev, spec->vlans[i].vid)) num_new++;
+        }
+        status = SJA1105_VLANTableReserve(&dev, num_new);
+        if (status != SJA1105_OK) goto end;
+
+        for (uint_fast16_t i = 0; i < spec->num_vlans; i++) {
+            SJA1105_VLANEntryPack(&spec->vlans[i], entry);
+            shadow = SJA1105_VLANGetEntry(&dev, spec->vlans[i].vid);
+            if (shadow != NULL) {
+                memcpy(shadow, entry, sizeof(entry));
+            } else {
+                status = SJA1105_VLANTableAppend(&dev, entry);
+                if (status != SJA1105_OK) goto end;
+            }
+            SJA1105_TableMarkDirty(&dev.tables.vlan_lookup, spec->vlans[i].vid);
+        }
+    }
+
+    /* Replace the policers */
+    if (spec->num_policers > 0) {
+        if (!dev.tables.l2_policing.in_use) status = SJA1105_MISSING_TABLE_ERROR;
+        if ((spec->num_policers * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE) > *dev.tables.l2_policing.size) status = SJA1105_PARAMETER_ERROR;
+        if (status != SJA1105_OK) goto end;
+        status = SJA1105_TableMakeWritable(&dev, &dev.tables.l2_policing);
+        if (status != SJA1105_OK) goto end;
+
+        for (uint_fast8_t i = 0; i < spec->num_policers; i++) {
+            SJA1105_PolicerEntryPack(&spec->policers[i], dev.tables.l2_policing.data + (i * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE));
+            SJA1105_TableMarkDirty(&dev.tables.l2_policing, i);
+        }
+    }
+
+    /* Replace the forwarding entry of each port */
+    if (spec->forwarding != NULL) {
+        for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+            SJA1105_L2ForwardingEntryPack(&spec->forwarding[port_num], dev.tables.l2_forwarding.data + (port_num * SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE));
+            SJA1105_TableMarkDirty(&dev.tables.l2_forwarding, port_num);
+        }
+    }
+
+    /* Check the edited tables again, on their own and against the rest of the config */
+    status = SJA1105_CheckTable(&dev, SJA1105_BLOCK_ID_L2_POLICING, dev.tables.l2_policing.data, *dev.tables.l2_policing.size);
+    if (status != SJA1105_OK) goto end;
+    status = SJA1105_CheckTable(&dev, SJA1105_BLOCK_ID_L2_FORWARDING, dev.tables.l2_forwarding.data, *dev.tables.l2_forwarding.size);
+    if (status != SJA1105_OK) goto end;
+    status = SJA1105_CheckTableConsistency(&dev);
+    if (status != SJA1105_OK) goto end;
+
+    /* Write out the image, calculating every CRC */
+    status = SJA1105_SerialiseStaticConfig(&dev, image, capacity, size);
+    if (status != SJA1105_OK) goto end;
+
+end:
+    if (status == SJA1105_OK) {
+        status = SJA1105_FreeAllTableMemory(&dev);
+    } else {
+        SJA1105_FreeAllTableMemory(&dev);
+    }
+
+    return status;
+}
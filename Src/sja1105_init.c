@@ -126,6 +126,27 @@ sja1105_status_t SJA1105_Init(
     /* Reset management routes */
     SJA1105_ResetManagementRoutes(dev);
 
+    /* Reset the transaction state */
+    SJA1105_ResetTransaction(dev);
+
+    /* Start scrubbing from the first table */
+    SJA1105_ResetScrubber(dev);
+
+    /* Disable storm control */
+    SJA1105_ResetStormControl(dev);
+
+    /* Every port starts awake */
+    SJA1105_ResetPortSleep(dev);
+
+    /* No link change callbacks until they are set */
+    SJA1105_ResetLinkMonitor(dev);
+
+    /* No temperature reading or alarm yet */
+    SJA1105_ResetTempMonitor(dev);
+
+    /* Start the SGMII PCS at the configured speed, or with autonegotiation for dynamic ports */
+    dev->sgmii_speed = config->ports[SJA1105_SGMII_PORT].speed;
+
     /* Set pins to a known state */
     HAL_GPIO_WritePin(dev->config->rst_port, dev->config->rst_pin, SET);
     HAL_GPIO_WritePin(dev->config->cs_port, dev->config->cs_pin, SET);
@@ -138,9 +159,6 @@ sja1105_status_t SJA1105_Init(
     status = SJA1105_LoadStaticConfig(dev, static_conf, static_conf_size);
     if (status != SJA1105_OK) goto end;
 
-    /* TODO: Configure SGMII PHY/PCS (optional) */
-
-
     /* Configure the SJA1105 */
 
     /* Reset */
@@ -200,6 +218,24 @@ sja1105_status_t SJA1105_DeInit(sja1105_handle_t *dev, bool hard, bool clear_cou
     /* Clear info about management routes */
     SJA1105_ResetManagementRoutes(dev);
 
+    /* Discard any open transaction */
+    SJA1105_ResetTransaction(dev);
+
+    /* Start scrubbing from the first table */
+    SJA1105_ResetScrubber(dev);
+
+    /* Disable storm control, the policing table it measures was freed */
+    SJA1105_ResetStormControl(dev);
+
+    /* Forget sleeping ports, the switch will be reset */
+    SJA1105_ResetPortSleep(dev);
+
+    /* Forget the link change callbacks and the last sample */
+    SJA1105_ResetLinkMonitor(dev);
+
+    /* Forget the temperature alarm and the last reading */
+    SJA1105_ResetTempMonitor(dev);
+
     /* Set the device to uninitialised */
     dev->initialised = false;
 
@@ -251,8 +287,15 @@ void SJA1105_ResetTables(sja1105_handle_t *dev, uint32_t fixed_length_table_buff
         dev->tables.by_index[i].data           = NULL;
         dev->tables.by_index[i].data_crc       = NULL;
         dev->tables.by_index[i].data_crc_valid = false;
+        dev->tables.by_index[i].dirty          = NULL;
+        dev->tables.by_index[i].capacity       = 0;
+        dev->tables.by_index[i].borrowed       = false;
     }
 
+    /* Reset the VLAN ID index */
+    dev->tables.vlan_present = NULL;
+    dev->tables.vlan_index   = NULL;
+
     /* Reset the static config global CRC */
     dev->tables.global_crc       = 0;
     dev->tables.global_crc_valid = false;
@@ -268,6 +311,54 @@ void SJA1105_ResetManagementRoutes(sja1105_handle_t *dev) {
 }
 
 
+/* Discard any open transaction. Note this doesn't give the mutex taken by SJA1105_TransactionBegin() */
+void SJA1105_ResetTransaction(sja1105_handle_t *dev) {
+    dev->transaction.open        = false;
+    dev->transaction.num_entries = 0;
+}
+
+
+/* Start the next SJA1105_Scrub() from the first entry of the first table */
+void SJA1105_ResetScrubber(sja1105_handle_t *dev) {
+    dev->scrubber.table = 0;
+    dev->scrubber.entry = 0;
+}
+
+
+/* Disable storm control on every port */
+void SJA1105_ResetStormControl(sja1105_handle_t *dev) {
+    memset(dev->storm_control, 0, sizeof(dev->storm_control));
+}
+
+
+/* Mark every port as awake */
+void SJA1105_ResetPortSleep(sja1105_handle_t *dev) {
+    dev->port_sleep.asleep  = 0;
+    dev->port_sleep.ingress = 0;
+    dev->port_sleep.egress  = 0;
+}
+
+
+/* Remove the link change callbacks and forget the last sample */
+void SJA1105_ResetLinkMonitor(sja1105_handle_t *dev) {
+    memset(&dev->link_monitor, 0, sizeof(dev->link_monitor));
+}
+
+
+/* Remove the temperature alarm and forget the last reading */
+void SJA1105_ResetTempMonitor(sja1105_handle_t *dev) {
+    dev->temp_monitor.config.alarm_x10 = INT16_MAX;
+    dev->temp_monitor.config.clear_x10 = INT16_MAX;
+    dev->temp_monitor.config.callback  = NULL;
+    dev->temp_monitor.config.context   = NULL;
+    dev->temp_monitor.index            = 0;
+    dev->temp_monitor.tracking         = false;
+    dev->temp_monitor.over             = false;
+    dev->temp_monitor.temp_x10         = 0;
+    dev->temp_monitor.valid            = false;
+}
+
+
 /* Reset event counters */
 void SJA1105_ResetEventCounters(sja1105_handle_t *dev) {
     memset(&dev->events, 0, sizeof(sja1105_event_counters_t));
@@ -5,6 +5,8 @@
  *      Author: bens1
  */
 
+#include "memory.h"
+
 #include "sja1105.h"
 #include "internal/sja1105_io.h"
 #include "internal/sja1105_regs.h"
@@ -39,6 +41,7 @@ sja1105_status_t __SJA1105_ReadRegister(sja1105_handle_t *dev, uint32_t addr, ui
         SJA1105_DELAY_NS(SJA1105_T_SPI_WR);
         HAL_GPIO_WritePin(dev->config->cs_port, dev->config->cs_pin, RESET);
         SJA1105_DELAY_NS(SJA1105_T_SPI_LEAD);
+        dev->events.spi_transactions++;
 
         /* Send command frame */
         if (HAL_SPI_Transmit(dev->config->spi_handle, (uint8_t *) &command_frame, 1, dev->config->timeout) != HAL_OK) {
@@ -166,6 +169,7 @@ sja1105_status_t SJA1105_WriteRegister(sja1105_handle_t *dev, uint32_t addr, con
         SJA1105_DELAY_NS(SJA1105_T_SPI_WR);
         HAL_GPIO_WritePin(dev->config->cs_port, dev->config->cs_pin, RESET);
         SJA1105_DELAY_NS(SJA1105_T_SPI_LEAD);
+        dev->events.spi_transactions++;
 
         /* Send command frame */
         if (HAL_SPI_Transmit(dev->config->spi_handle, (uint8_t *) &command_frame, 1, dev->config->timeout) != HAL_OK) {
@@ -199,6 +203,327 @@ end:
 }
 
 
+const sja1105_dyn_conf_t SJA1105_DYN_CONF_L2_LUT_DESC = {
+    .entry_addr = SJA1105_DYN_CONF_L2_LUT_REG_1,
+    .cmd_addr   = SJA1105_DYN_CONF_L2_LUT_REG_0,
+    .entry_size = SJA1105_L2ADDR_LU_ENTRY_SIZE,
+    .valid      = SJA1105_DYN_CONF_L2_LUT_VALID,
+    .rdwrset    = SJA1105_DYN_CONF_L2_LUT_RDRWSET,
+    .errors     = SJA1105_DYN_CONF_L2_LUT_ERRORS,
+};
+
+const sja1105_dyn_conf_t SJA1105_DYN_CONF_L2_FORWARDING_DESC = {
+    .entry_addr = SJA1105_DYN_CONF_L2_FORWARDING_REG_1,
+    .cmd_addr   = SJA1105_DYN_CONF_L2_FORWARDING_REG_0,
+    .entry_size = SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE,
+    .valid      = SJA1105_DYN_CONF_VALID,
+    .rdwrset    = SJA1105_DYN_CONF_RDWRSET,
+    .errors     = SJA1105_DYN_CONF_ERRORS,
+};
+
+const sja1105_dyn_conf_t SJA1105_DYN_CONF_MAC_CONF_DESC = {
+    .entry_addr = SJA1105_DYN_CONF_MAC_CONF_REG_1,
+    .cmd_addr   = SJA1105_DYN_CONF_MAC_CONF_REG_0,
+    .entry_size = SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE,
+    .valid      = SJA1105_DYN_CONF_VALID,
+    .rdwrset    = SJA1105_DYN_CONF_RDWRSET,
+    .errors     = SJA1105_DYN_CONF_ERRORS,
+};
+
+const sja1105_dyn_conf_t SJA1105_DYN_CONF_VLAN_LOOKUP_DESC = {
+    .entry_addr = SJA1105_DYN_CONF_VLAN_LOOKUP_REG_1,
+    .cmd_addr   = SJA1105_DYN_CONF_VLAN_LOOKUP_REG_0,
+    .entry_size = SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE,
+    .valid      = SJA1105_DYN_CONF_VLAN_LOOKUP_VALID,
+    .rdwrset    = SJA1105_DYN_CONF_VLAN_LOOKUP_RDWRSET,
+    .errors     = 0,
+};
+
+const sja1105_dyn_conf_t SJA1105_DYN_CONF_RETAGGING_DESC = {
+    .entry_addr = SJA1105_DYN_CONF_RETAGGING_REG_1,
+    .cmd_addr   = SJA1105_DYN_CONF_RETAGGING_REG_0,
+    .entry_size = SJA1105_STATIC_CONF_RETAGGING_ENTRY_SIZE,
+    .valid      = SJA1105_DYN_CONF_RETAGGING_VALID,
+    .rdwrset    = SJA1105_DYN_CONF_RETAGGING_RDWRSET,
+    .errors     = SJA1105_DYN_CONF_RETAGGING_ERRORS,
+};
+
+const sja1105_dyn_conf_t SJA1105_DYN_CONF_GENERAL_PARAMS_DESC = {
+    .entry_addr = SJA1105_DYN_CONF_GENERAL_PARAMS_REG_1,
+    .cmd_addr   = SJA1105_DYN_CONF_GENERAL_PARAMS_REG_0,
+    .entry_size = SJA1105_STATIC_CONF_GENERAL_PARAMS_SIZE,
+    .valid      = SJA1105_DYN_CONF_GENERAL_PARAMS_VALID,
+    .rdwrset    = SJA1105_DYN_CONF_GENERAL_PARAMS_RDWRSET,
+    .errors     = SJA1105_DYN_CONF_GENERAL_PARAMS_ERRORS,
+};
+
+const sja1105_dyn_conf_t SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_DESC = {
+    .entry_addr = SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_REG_1,
+    .cmd_addr   = SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_REG_0,
+    .entry_size = SJA1105_STATIC_CONF_L2_LOOKUP_PARAMS_SIZE,
+    .valid      = SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_VALID,
+    .rdwrset    = SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_RDWRSET,
+    .errors     = 0,
+};
+
+
+/* Repeatedly read the command register of a dynamic reconfiguration interface until VALID is 0 or dev->config->timeout ms have passed.
+ *
+ * The final command register value is returned in command so the caller can check ERRORS without another access. If entry isn't NULL
+ * then the entry registers are also returned. When the entry registers directly precede the command register they are read in the
+ * same transaction as the command register, so polling and reading the result costs a single access when the operation has finished.
+ *
+ * Note: The VALID bit should be write only, but the documentation mentions "On read [of ERRORS] it has meaning at times when VALID is found reset".
+ *       How can VALID be found reset if it cannot be read? Write only bits return 0 on read so there is no harm in polling until it is 0.
+ */
+sja1105_status_t SJA1105_DynConfPoll(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, uint32_t *command, uint32_t *entry) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         reg_data[SJA1105_DYN_CONF_MAX_ENTRY_SIZE + 1];
+    bool             burst = (entry != NULL) && SJA1105_DYN_CONF_IS_CONTIGUOUS(dyn_conf);
+    uint32_t         addr  = burst ? dyn_conf->entry_addr : dyn_conf->cmd_addr;
+    uint32_t         size  = burst ? dyn_conf->entry_size + 1 : 1;
+
+    /* Parameter checking */
+    if (dyn_conf->entry_size > SJA1105_DYN_CONF_MAX_ENTRY_SIZE) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Read the command register up to SJA1105_MAX_ATTEMPTS times */
+    for (uint_fast8_t i = 0; i < SJA1105_MAX_ATTEMPTS; i++) {
+        status = SJA1105_ReadRegister(dev, addr, reg_data, size);
+        if (status != SJA1105_OK) return status;
+        if ((reg_data[size - 1] & dyn_conf->valid) == 0) break;
+        dev->callbacks->callback_delay_ms(dev, dev->config->timeout / SJA1105_MAX_ATTEMPTS);
+    }
+
+    /* If the loop reaches the end and VALID is still set */
+    if (reg_data[size - 1] & dyn_conf->valid) status = SJA1105_TIMEOUT;
+    if (status != SJA1105_OK) return status;
+
+    /* Return the command register */
+    *command = reg_data[size - 1];
+
+    /* Return the entry */
+    if (entry != NULL) {
+        if (burst) {
+            memcpy(entry, reg_data, dyn_conf->entry_size * sizeof(uint32_t));
+        } else {
+            status = SJA1105_ReadRegister(dev, dyn_conf->entry_addr, entry, dyn_conf->entry_size);
+            if (status != SJA1105_OK) return status;
+        }
+    }
+
+    return status;
+}
+
+
+/* Start a dynamic reconfiguration operation by writing the entry (if not NULL) and the command. VALID is set by this function.
+ * If the register map allows it then the entry and command are written in a single transaction. This function doesn't wait for
+ * the operation to finish.
+ */
+sja1105_status_t SJA1105_DynConfCommand(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, uint32_t command, const uint32_t *entry) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         reg_data[SJA1105_DYN_CONF_MAX_ENTRY_SIZE + 1];
+
+    /* Parameter checking */
+    if (dyn_conf->entry_size > SJA1105_DYN_CONF_MAX_ENTRY_SIZE) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    command |= dyn_conf->valid;
+
+    /* Only the command needs to be written */
+    if (entry == NULL) {
+        status = SJA1105_WriteRegister(dev, dyn_conf->cmd_addr, &command, 1);
+    }
+
+    /* Write the entry and command in one transaction */
+    else if (SJA1105_DYN_CONF_IS_CONTIGUOUS(dyn_conf)) {
+        memcpy(reg_data, entry, dyn_conf->entry_size * sizeof(uint32_t));
+        reg_data[dyn_conf->entry_size] = command;
+        status                         = SJA1105_WriteRegister(dev, dyn_conf->entry_addr, reg_data, dyn_conf->entry_size + 1);
+    }
+
+    /* Write the entry then the command */
+    else {
+        status = SJA1105_WriteRegister(dev, dyn_conf->entry_addr, entry, dyn_conf->entry_size);
+        if (status != SJA1105_OK) return status;
+        status = SJA1105_WriteRegister(dev, dyn_conf->cmd_addr, &command, 1);
+    }
+
+    return status;
+}
+
+
+/* Write an entry using a dynamic reconfiguration interface and wait for it to be applied. Any index or
+ * table specific flags should be set in command, VALID and RDWRSET are set by this function.
+ *
+ * This takes 3 SPI transactions when the interface is idle and completes quickly: one to check VALID,
+ * one to write the entry and command, and one to wait for VALID and read ERRORS.
+ */
+sja1105_status_t SJA1105_DynConfWrite(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, uint32_t command, const uint32_t *entry) {
+
+    sja1105_status_t status       = SJA1105_OK;
+    uint32_t         transactions = dev->events.spi_transactions;
+    uint32_t         reg_data     = 0;
+
+    /* Wait for VALID to be 0 */
+    status = SJA1105_DynConfPoll(dev, dyn_conf, &reg_data, NULL);
+    if (status != SJA1105_OK) goto end;
+
+    /* Write the entry and apply it */
+    status = SJA1105_DynConfCommand(dev, dyn_conf, command | dyn_conf->rdwrset, entry);
+    if (status != SJA1105_OK) goto end;
+
+    /* Wait for VALID to be 0 */
+    status = SJA1105_DynConfPoll(dev, dyn_conf, &reg_data, NULL);
+    if (status != SJA1105_OK) goto end;
+
+    /* If ERRORS is set then the configuration is invalid and was not applied */
+    if (reg_data & dyn_conf->errors) status = SJA1105_DYNAMIC_RECONFIG_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+end:
+
+    /* Record the number of accesses used */
+    dev->events.dyn_conf_writes++;
+    dev->events.dyn_conf_transactions += dev->events.spi_transactions - transactions;
+
+    return status;
+}
+
+
+/* Read an entry using a dynamic reconfiguration interface. Any index or table specific flags should be set
+ * in command, VALID is set and RDWRSET is cleared by this function. If the table is indexed using the entry
+ * registers (e.g. the L2 lookup table) then key should contain the entry to write before the read command,
+ * otherwise it should be NULL.
+ */
+sja1105_status_t SJA1105_DynConfRead(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, uint32_t command, const uint32_t *key, uint32_t *entry) {
+
+    sja1105_status_t status       = SJA1105_OK;
+    uint32_t         transactions = dev->events.spi_transactions;
+    uint32_t         reg_data     = 0;
+
+    /* Wait for VALID to be 0 */
+    status = SJA1105_DynConfPoll(dev, dyn_conf, &reg_data, NULL);
+    if (status != SJA1105_OK) goto end;
+
+    /* Write the key (if there is one) and the read command */
+    status = SJA1105_DynConfCommand(dev, dyn_conf, command & ~dyn_conf->rdwrset, key);
+    if (status != SJA1105_OK) goto end;
+
+    /* Wait for VALID to be 0 and read the entry */
+    status = SJA1105_DynConfPoll(dev, dyn_conf, &reg_data, entry);
+    if (status != SJA1105_OK) goto end;
+
+    /* Check ERRORS */
+    if (reg_data & dyn_conf->errors) status = SJA1105_DYNAMIC_RECONFIG_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+end:
+
+    /* Record the number of accesses used */
+    dev->events.dyn_conf_reads++;
+    dev->events.dyn_conf_transactions += dev->events.spi_transactions - transactions;
+
+    return status;
+}
+
+
+/* Write several entries using the same dynamic reconfiguration interface. Instead of waiting for each write to complete
+ * before starting the next, the poll that checks VALID before each write also returns ERRORS for the previous write.
+ * This takes 2 SPI transactions per entry plus one to wait for the final write, instead of 3 per entry. commands[i]
+ * and entries[i] are used as in SJA1105_DynConfWrite(). Stops at the first entry that reports ERRORS.
+ */
+sja1105_status_t SJA1105_DynConfWriteMultiple(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, const uint32_t *commands, const uint32_t *const *entries, uint32_t count) {
+
+    sja1105_status_t status       = SJA1105_OK;
+    uint32_t         transactions = dev->events.spi_transactions;
+    uint32_t         reg_data     = 0;
+    uint32_t         written      = 0;
+
+    /* Nothing to do */
+    if (count == 0) return status;
+
+    for (written = 0; written < count; written++) {
+
+        /* Wait for VALID to be 0, if this isn't the first write then this is also the previous write's completion */
+        status = SJA1105_DynConfPoll(dev, dyn_conf, &reg_data, NULL);
+        if (status != SJA1105_OK) goto end;
+
+        /* If ERRORS is set then the previous configuration is invalid and was not applied */
+        if ((written != 0) && (reg_data & dyn_conf->errors)) status = SJA1105_DYNAMIC_RECONFIG_ERROR;
+        if (status != SJA1105_OK) goto end;
+
+        /* Write the entry and apply it */
+        status = SJA1105_DynConfCommand(dev, dyn_conf, commands[written] | dyn_conf->rdwrset, entries[written]);
+        if (status != SJA1105_OK) goto end;
+    }
+
+    /* Wait for the final write to complete */
+    status = SJA1105_DynConfPoll(dev, dyn_conf, &reg_data, NULL);
+    if (status != SJA1105_OK) goto end;
+
+    /* Check ERRORS for the final write */
+    if (reg_data & dyn_conf->errors) status = SJA1105_DYNAMIC_RECONFIG_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+end:
+
+    /* Record the number of accesses used */
+    dev->events.dyn_conf_writes       += written;
+    dev->events.dyn_conf_transactions += dev->events.spi_transactions - transactions;
+
+    return status;
+}
+
+
+/* Read several entries using the same dynamic reconfiguration interface. The poll that waits for each read to complete
+ * also returns the entry and shows the interface is idle for the next read, so this takes 2 SPI transactions per entry
+ * plus one to check the interface is idle, instead of 3 per entry. commands[i] and keys[i] are used as in SJA1105_DynConfRead(),
+ * keys can be NULL if none of the reads need a key. If results isn't NULL then the command register after each read is
+ * returned so table specific flags such as VALIDENT can be checked. Stops at the first entry that reports ERRORS.
+ */
+sja1105_status_t SJA1105_DynConfReadMultiple(sja1105_handle_t *dev, const sja1105_dyn_conf_t *dyn_conf, const uint32_t *commands, const uint32_t *const *keys, uint32_t *const *entries, uint32_t *results, uint32_t count) {
+
+    sja1105_status_t status       = SJA1105_OK;
+    uint32_t         transactions = dev->events.spi_transactions;
+    uint32_t         reg_data     = 0;
+    uint32_t         read         = 0;
+
+    /* Nothing to do */
+    if (count == 0) return status;
+
+    /* Wait for VALID to be 0 */
+    status = SJA1105_DynConfPoll(dev, dyn_conf, &reg_data, NULL);
+    if (status != SJA1105_OK) goto end;
+
+    for (read = 0; read < count; read++) {
+
+        /* Write the key (if there is one) and the read command */
+        status = SJA1105_DynConfCommand(dev, dyn_conf, commands[read] & ~dyn_conf->rdwrset, (keys != NULL) ? keys[read] : NULL);
+        if (status != SJA1105_OK) goto end;
+
+        /* Wait for VALID to be 0 and read the entry. The interface is then idle for the next read */
+        status = SJA1105_DynConfPoll(dev, dyn_conf, &reg_data, entries[read]);
+        if (status != SJA1105_OK) goto end;
+        if (results != NULL) results[read] = reg_data;
+
+        /* Check ERRORS */
+        if (reg_data & dyn_conf->errors) status = SJA1105_DYNAMIC_RECONFIG_ERROR;
+        if (status != SJA1105_OK) goto end;
+    }
+
+end:
+
+    /* Record the number of accesses used */
+    dev->events.dyn_conf_reads        += read;
+    dev->events.dyn_conf_transactions += dev->events.spi_transactions - transactions;
+
+    return status;
+}
+
+
 /* Write a table to the chip */
 sja1105_status_t SJA1105_WriteTable(sja1105_handle_t *dev, uint32_t addr, sja1105_table_t *table, bool safe) {
 
@@ -229,6 +554,7 @@ sja1105_status_t SJA1105_WriteTable(sja1105_handle_t *dev, uint32_t addr, sja110
     SJA1105_DELAY_NS(SJA1105_T_SPI_WR);
     HAL_GPIO_WritePin(dev->config->cs_port, dev->config->cs_pin, RESET);
     SJA1105_DELAY_NS(SJA1105_T_SPI_LEAD);
+    dev->events.spi_transactions++;
 
     /* Send command frame */
     if (HAL_SPI_Transmit(dev->config->spi_handle, (uint8_t *) &command_frame, 1, dev->config->timeout) != HAL_OK) {
@@ -346,6 +672,7 @@ sja1105_status_t SJA1105_L2LUTInvalidateRange(sja1105_handle_t *dev, uint16_t lo
         SJA1105_DELAY_NS(SJA1105_T_SPI_WR);
         HAL_GPIO_WritePin(dev->config->cs_port, dev->config->cs_pin, RESET);
         SJA1105_DELAY_NS(SJA1105_T_SPI_LEAD);
+        dev->events.spi_transactions++;
 
         /* Write the invalidate command */
         if (HAL_SPI_Transmit(dev->config->spi_handle, (uint8_t *) reg_data, size, dev->config->timeout) != HAL_OK) {
@@ -374,6 +701,9 @@ void SJA1105_FullReset(sja1105_handle_t *dev) {
 
     /* Increment the internal reset counter */
     dev->events.resets++;
+
+    /* The reset clears the RAM parity error registers */
+    dev->ram_parity_repaired = 0;
 }
 
 
@@ -388,6 +718,9 @@ sja1105_status_t SJA1105_CfgReset(sja1105_handle_t *dev) {
     /* Increment the internal reset counter */
     dev->events.resets++;
 
+    /* The reset clears the RAM parity error registers */
+    dev->ram_parity_repaired = 0;
+
     /* Delay to wait for startup */
     SJA1105_DELAY_NS(SJA1105_T_RST_STARTUP_SW);
 
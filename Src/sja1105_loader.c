@@ -0,0 +1,476 @@
+/*
+ * sja1105_loader.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bens1
+ */
+
+#include "memory.h"
+
+#include "sja1105.h"
+#include "internal/sja1105_conf.h"
+#include "internal/sja1105_io.h"
+#include "internal/sja1105_regs.h"
+#include "internal/sja1105_tables.h"
+
+
+/* Source for the runs of zeros in compressed images */
+static const uint32_t sja1105_loader_zeros[16] = {0};
+
+
+/* Reset the device and write the device ID, ready for the tables to be streamed to it. This is left until the first table
+ * has been loaded and checked so the switch keeps forwarding with its old config for as long as possible.
+ */
+static sja1105_status_t SJA1105_LoaderStartUpload(sja1105_handle_t *dev, sja1105_loader_t *loader) {
+
+    sja1105_status_t status   = SJA1105_OK;
+    uint32_t         reg_data = 0;
+
+    SJA1105_FullReset(dev);
+    status = SJA1105_CheckPartID(dev);
+    if (status != SJA1105_OK) return status;
+
+    status = SJA1105_WriteRegister(dev, SJA1105_STATIC_CONF_ADDR, dev->tables.device_id, 1);
+    if (status != SJA1105_OK) return status;
+    status = SJA1105_ReadStaticConfFlags(dev, &reg_data);
+    if (status != SJA1105_OK) return status;
+    if ((reg_data & SJA1105_IDS_MASK) != 0) status = SJA1105_ID_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    loader->crc_state = SJA1105_CRC32Update(loader->crc_state, dev->tables.device_id, 1);
+    loader->offset    = 1;
+
+    return status;
+}
+
+
+/* Write a loaded table to the device after the ones already written, and add it to the global CRC */
+static sja1105_status_t SJA1105_LoaderWriteTable(sja1105_handle_t *dev, sja1105_loader_t *loader, sja1105_table_t *table) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         header[SJA1105_STATIC_CONF_BLOCK_HEADER + SJA1105_STATIC_CONF_BLOCK_HEADER_CRC];
+    uint32_t         crc_value;
+
+    /* Nothing has been written yet so start the upload */
+    if (loader->offset == 0) {
+        status = SJA1105_LoaderStartUpload(dev, loader);
+        if (status != SJA1105_OK) return status;
+    }
+
+    /* Tables changed after loading need their CRC calculating */
+    if (!table->data_crc_valid) {
+        status = dev->callbacks->callback_crc_reset(dev);
+        if (status != SJA1105_OK) return status;
+        status = dev->callbacks->callback_crc_accumulate(dev, table->data, *table->size, &crc_value);
+        if (status != SJA1105_OK) return status;
+        *table->data_crc      = crc_value;
+        table->data_crc_valid = true;
+    }
+
+    status = SJA1105_WriteTable(dev, SJA1105_STATIC_CONF_ADDR + loader->offset, table, true);
+    if (status != SJA1105_OK) return status;
+
+    /* The CRC callbacks are used for the block CRCs in between writes, so the global CRC is kept in software */
+    header[SJA1105_STATIC_CONF_BLOCK_ID_OFFSET]   = ((uint32_t) *table->id) << SJA1105_STATIC_CONF_BLOCK_ID_SHIFT;
+    header[SJA1105_STATIC_CONF_BLOCK_SIZE_OFFSET] = (*table->size << SJA1105_STATIC_CONF_BLOCK_SIZE_SHIFT) & SJA1105_STATIC_CONF_BLOCK_SIZE_MASK;
+    header[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET] = *table->header_crc;
+    loader->crc_state                             = SJA1105_CRC32Update(loader->crc_state, header, SJA1105_STATIC_CONF_BLOCK_HEADER + SJA1105_STATIC_CONF_BLOCK_HEADER_CRC);
+    loader->crc_state                             = SJA1105_CRC32Update(loader->crc_state, table->data, *table->size);
+    loader->crc_state                             = SJA1105_CRC32Update(loader->crc_state, table->data_crc, SJA1105_STATIC_CONF_BLOCK_DATA_CRC);
+
+    loader->offset     += SJA1105_STATIC_CONF_BLOCK_OVERHEAD + *table->size;
+    loader->streamed   |= (uint32_t) 1 << SJA1105_GET_TABLE_INDEX(*table->id);
+    loader->next_index  = SJA1105_GET_TABLE_INDEX(*table->id) + 1;
+
+    return status;
+}
+
+
+/* Handle a complete device ID, block header or block */
+static sja1105_status_t SJA1105_LoaderStep(sja1105_handle_t *dev, sja1105_loader_t *loader) {
+
+    sja1105_status_t   status = SJA1105_OK;
+    sja1105_block_id_t id     = 0;
+    uint32_t           size   = 0;
+    uint8_t            index;
+
+    switch (loader->state) {
+
+        case SJA1105_LOADER_DEVICE_ID:
+            status = SJA1105_CheckDeviceID(dev, loader->header[0]);
+            if (status != SJA1105_OK) return status;
+            *dev->tables.device_id = loader->header[0];
+            loader->total          = 1;
+            loader->state          = SJA1105_LOADER_HEADER;
+            loader->received = 0;
+            break;
+
+        case SJA1105_LOADER_HEADER:
+            id   = (loader->header[SJA1105_STATIC_CONF_BLOCK_ID_OFFSET] & SJA1105_STATIC_CONF_BLOCK_ID_MASK) >> SJA1105_STATIC_CONF_BLOCK_ID_SHIFT;
+            size = (loader->header[SJA1105_STATIC_CONF_BLOCK_SIZE_OFFSET] & SJA1105_STATIC_CONF_BLOCK_SIZE_MASK) >> SJA1105_STATIC_CONF_BLOCK_SIZE_SHIFT;
+
+            /* Last block has size = 0 and id = 0, only its global CRC is left */
+            if ((size == 0) && (id == 0)) {
+                loader->state = SJA1105_LOADER_LAST;
+                break;
+            }
+
+            /* Non-final block has size = 0 */
+            if (size == 0) status = SJA1105_STATIC_CONF_ERROR;
+            if (SJA1105_GET_TABLE_INDEX(id) == UINT8_MAX) status = SJA1105_STATIC_CONF_ERROR;
+            if (status != SJA1105_OK) return status;
+
+            /* Only the current block is ever held in RAM */
+            loader->block_size = size + SJA1105_STATIC_CONF_BLOCK_OVERHEAD;
+            status             = dev->callbacks->callback_allocate(dev, &loader->block, loader->block_size);
+            if (status != SJA1105_OK) return status;
+            memcpy(loader->block, loader->header, SJA1105_STATIC_CONF_BLOCK_HEADER * sizeof(uint32_t));
+            loader->state = SJA1105_LOADER_BLOCK;
+            break;
+
+        case SJA1105_LOADER_BLOCK:
+            id     = (loader->block[SJA1105_STATIC_CONF_BLOCK_ID_OFFSET] & SJA1105_STATIC_CONF_BLOCK_ID_MASK) >> SJA1105_STATIC_CONF_BLOCK_ID_SHIFT;
+            index  = SJA1105_GET_TABLE_INDEX(id);
+            status = SJA1105_LoadBlock(dev, loader->block, loader->block_size, false);
+            if (status != SJA1105_OK) return status;
+            loader->total += loader->block_size;
+
+            status = dev->callbacks->callback_free(dev, loader->block);
+            if (status != SJA1105_OK) return status;
+            loader->block = NULL;
+
+            /* Tables are written in order, and the ones changed by SJA1105_LoadStaticConfigFinish() (from the MAC
+             * configuration onwards) are left until the end. If the device rejects a block then stop streaming and upload
+             * everything at the end instead.
+             */
+            if (loader->stream && (index >= loader->next_index) && (index < SJA1105_GET_TABLE_INDEX(SJA1105_BLOCK_ID_MAC_CONF))) {
+                if (SJA1105_LoaderWriteTable(dev, loader, &dev->tables.by_index[index]) != SJA1105_OK) loader->stream = false;
+            }
+
+            loader->state    = SJA1105_LOADER_HEADER;
+            loader->received = 0;
+            break;
+
+        case SJA1105_LOADER_LAST:
+            loader->total += SJA1105_STATIC_CONF_BLOCK_LAST_SIZE;
+            loader->state  = SJA1105_LOADER_DONE;
+            break;
+
+        default:
+            status = SJA1105_STATIC_CONF_ERROR;
+            break;
+    }
+
+    return status;
+}
+
+
+/* Start loading a new static config in chunks with SJA1105_LoaderFeed(), replacing the current one (like SJA1105_ReInit()).
+ * SJA1105_Init() must have been called before, but the device doesn't need to still be initialised so a failed load can be
+ * retried. If stream is true the device is reset once the first block it can take has been loaded and checked, and blocks
+ * are written to it as soon as they are loaded from then on. Otherwise it keeps running until SJA1105_LoaderEnd() uploads
+ * the whole config. The switch stops forwarding while a config is streamed, so don't use stream mode if the chunks
+ * themselves arrive through the switch.
+ */
+sja1105_status_t SJA1105_LoaderBegin(sja1105_handle_t *dev, sja1105_loader_t *loader, bool stream) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check SJA1105_Init() has set up the handle */
+    if ((dev->config == NULL) || (dev->callbacks == NULL) || (dev->tables.fixed_length_buffer == NULL)) return SJA1105_NOT_CONFIGURED_ERROR;
+
+    /* Take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (dev->transaction.open) status = SJA1105_BUSY;
+    if (status != SJA1105_OK) goto end;
+
+    /* Stop using the current config */
+    if (dev->initialised) {
+        status = SJA1105_DeInit(dev, false, false);
+        if (status != SJA1105_OK) goto end;
+    }
+
+    /* Free the tables here too since a failed load leaves the device uninitialised, so SJA1105_DeInit() does nothing */
+    status = SJA1105_FreeAllTableMemory(dev);
+    if (status != SJA1105_OK) goto end;
+    SJA1105_ResetTables(dev, dev->tables.fixed_length_buffer);
+
+    memset(loader, 0, sizeof(*loader));
+    loader->state     = SJA1105_LOADER_DEVICE_ID;
+    loader->stream    = stream;
+    loader->crc_state = SJA1105_CRC32_INIT;
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Load the next length bytes of the static config. Chunks can be any size, each block is checked and stored as soon as it
+ * is complete so only the current block is buffered.
+ */
+sja1105_status_t SJA1105_LoaderFeed(sja1105_handle_t *dev, sja1105_loader_t *loader, const uint8_t *data, uint32_t length) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint8_t         *dest   = NULL;
+    uint32_t         needed = 0; /* Number of bytes in the current part */
+    uint32_t         count  = 0;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (loader->state == SJA1105_LOADER_FAILED) status = SJA1105_STATIC_CONF_ERROR;
+    if ((loader->state == SJA1105_LOADER_DONE) && (length > 0)) status = SJA1105_STATIC_CONF_ERROR; /* Data after the last block */
+    if (status != SJA1105_OK) goto end;
+
+    while (length > 0) {
+
+        /* Find where the next bytes go */
+        switch (loader->state) {
+            case SJA1105_LOADER_DEVICE_ID:
+                dest   = (uint8_t *) loader->header;
+                needed = sizeof(uint32_t);
+                break;
+            case SJA1105_LOADER_HEADER:
+                dest   = (uint8_t *) loader->header;
+                needed = SJA1105_STATIC_CONF_BLOCK_HEADER * sizeof(uint32_t);
+                break;
+            case SJA1105_LOADER_BLOCK:
+                dest   = (uint8_t *) loader->block;
+                needed = loader->block_size * sizeof(uint32_t);
+                break;
+            case SJA1105_LOADER_LAST:
+                dest   = (uint8_t *) loader->header;
+                needed = SJA1105_STATIC_CONF_BLOCK_LAST_SIZE * sizeof(uint32_t);
+                break;
+            default:
+                status = SJA1105_STATIC_CONF_ERROR;
+                break;
+        }
+        if (status != SJA1105_OK) break;
+
+        /* Copy as much of the part as is available */
+        count = CONSTRAIN(needed - loader->received, 0, length);
+        memcpy(dest + loader->received, data, count);
+        loader->received += count;
+        data             += count;
+        length           -= count;
+        if (loader->received < needed) break;
+
+        status = SJA1105_LoaderStep(dev, loader);
+        if (status != SJA1105_OK) break;
+    }
+
+    /* A rejected block means the whole config is rejected */
+    if (status != SJA1105_OK) {
+        if (loader->block != NULL) dev->callbacks->callback_free(dev, loader->block);
+        loader->block = NULL;
+        loader->state = SJA1105_LOADER_FAILED;
+    }
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Load the next length bytes of a static config compressed with SJA1105_ImageCompress(). Chunks can be any size, literal
+ * runs are passed straight to SJA1105_LoaderFeed() and zero runs are fed from a small constant buffer, so nothing is
+ * decompressed into RAM first. Plain and compressed chunks must not be mixed.
+ */
+sja1105_status_t SJA1105_LoaderFeedCompressed(sja1105_handle_t *dev, sja1105_loader_t *loader, const uint8_t *data, uint32_t length) {
+
+    sja1105_status_t status    = SJA1105_OK;
+    uint32_t         remaining = 0;
+    uint32_t         count     = 0;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (loader->state == SJA1105_LOADER_FAILED) status = SJA1105_STATIC_CONF_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    while (length > 0) {
+
+        /* Pass on the rest of the current literal run */
+        if (loader->rle_remaining > 0) {
+            count  = CONSTRAIN(loader->rle_remaining, 0, length);
+            status = SJA1105_LoaderFeed(dev, loader, data, count);
+            if (status != SJA1105_OK) goto end;
+            loader->rle_remaining -= count;
+            data                  += count;
+            length                -= count;
+            continue;
+        }
+
+        /* Otherwise the next run starts with a control word */
+        count = CONSTRAIN(sizeof(uint32_t) - loader->rle_received, 0, length);
+        memcpy((uint8_t *) &loader->rle_control + loader->rle_received, data, count);
+        loader->rle_received += count;
+        data                 += count;
+        length               -= count;
+        if (loader->rle_received < sizeof(uint32_t)) break;
+        loader->rle_received = 0;
+
+        if (loader->rle_control & SJA1105_RLE_RESERVED) {
+            loader->state = SJA1105_LOADER_FAILED;
+            status        = SJA1105_STATIC_CONF_ERROR;
+            goto end;
+        }
+
+        /* Zero runs don't need any more input */
+        if (loader->rle_control & SJA1105_RLE_ZEROS) {
+            remaining = (loader->rle_control & SJA1105_RLE_COUNT_MASK) * sizeof(uint32_t);
+            while (remaining > 0) {
+                count  = CONSTRAIN(remaining, 0, sizeof(sja1105_loader_zeros));
+                status = SJA1105_LoaderFeed(dev, loader, (const uint8_t *) sja1105_loader_zeros, count);
+                if (status != SJA1105_OK) goto end;
+                remaining -= count;
+            }
+        } else {
+            loader->rle_remaining = (loader->rle_control & SJA1105_RLE_COUNT_MASK) * sizeof(uint32_t);
+        }
+    }
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Finish loading and upload the rest of the static config. This must be called after SJA1105_LoaderBegin() even if
+ * SJA1105_LoaderFeed() failed, so any memory used is freed. If the device isn't initialised at the end the tables are freed
+ * and it must be set up again with SJA1105_LoaderBegin().
+ */
+sja1105_status_t SJA1105_LoaderEnd(sja1105_handle_t *dev, sja1105_loader_t *loader) {
+
+    sja1105_status_t status                                             = SJA1105_OK;
+    uint32_t         end_block[SJA1105_STATIC_CONF_BLOCK_LAST_SIZE - 1] = {0, 0};
+    uint32_t         crc_value                                          = 0;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Free the partial block */
+    if (loader->block != NULL) {
+        status = dev->callbacks->callback_free(dev, loader->block);
+        if (status != SJA1105_OK) goto end;
+        loader->block = NULL;
+    }
+
+    /* Check the whole config was received */
+    if (loader->state != SJA1105_LOADER_DONE) status = SJA1105_STATIC_CONF_ERROR;
+    if (loader->total < SJA1105_STATIC_CONF_MIN_SIZE) status = SJA1105_STATIC_CONF_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    /* Check the tables and apply the port configuration */
+    status = SJA1105_LoadStaticConfigFinish(dev);
+    if (status != SJA1105_OK) goto end;
+
+    /* Only append the remaining tables if they all come after the ones already written */
+    for (uint_fast8_t i = 0; loader->stream && (i < loader->next_index); i++) {
+        if (dev->tables.by_index[i].in_use && !(loader->streamed & ((uint32_t) 1 << i))) loader->stream = false;
+    }
+
+    /* Write the remaining tables and the last block */
+    if (loader->stream) {
+        for (uint_fast8_t i = loader->next_index; i < SJA1105_NUM_TABLES; i++) {
+            if (!dev->tables.by_index[i].in_use) continue;
+            status = SJA1105_LoaderWriteTable(dev, loader, &dev->tables.by_index[i]);
+            if (status != SJA1105_OK) break;
+        }
+        if (status == SJA1105_OK) {
+            crc_value = ~SJA1105_CRC32Update(loader->crc_state, end_block, SJA1105_STATIC_CONF_BLOCK_LAST_SIZE - 1);
+            status    = SJA1105_WriteLastBlock(dev, loader->offset, crc_value);
+        }
+        if (status == SJA1105_OK) {
+            dev->tables.global_crc       = crc_value;
+            dev->tables.global_crc_valid = true;
+            status                       = SJA1105_FinishStaticConfigUpload(dev);
+            if (status != SJA1105_OK) goto end;
+        }
+    }
+
+    /* Otherwise upload everything, as SJA1105_Init() does */
+    if (!loader->stream || (status != SJA1105_OK)) {
+        SJA1105_FullReset(dev);
+        status = SJA1105_CheckPartID(dev);
+        if (status != SJA1105_OK) goto end;
+        status = SJA1105_SyncStaticConfig(dev);
+        if (status != SJA1105_OK) goto end;
+    }
+
+    /* Check the status registers */
+    status = SJA1105_CheckStatusRegisters(dev);
+    if (status != SJA1105_OK) goto end;
+
+end:
+    /* If the config wasn't applied free everything so SJA1105_LoaderBegin() can start again from an empty buffer */
+    if ((status != SJA1105_OK) && !dev->initialised) {
+        SJA1105_FreeAllTableMemory(dev);
+        SJA1105_ResetTables(dev, dev->tables.fixed_length_buffer);
+        loader->state = SJA1105_LOADER_FAILED;
+    }
+
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Write the current shadow tables, including every change made since initialisation, into image as a static config in the
+ * generic loader format with fresh CRCs. It can be stored and passed to SJA1105_Init() or SJA1105_ReInit() later to start
+ * the switch in the same state. If capacity is too small nothing is written, size is set to the number of uint32_t
+ * needed and SJA1105_PARAMETER_ERROR is returned. Call with capacity = 0 to just find the size, which returns SJA1105_OK.
+ */
+sja1105_status_t SJA1105_ExportStaticConfig(sja1105_handle_t *dev, uint32_t *image, uint32_t capacity, uint32_t *size) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (!dev->initialised) status = SJA1105_NOT_CONFIGURED_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    /* Size query */
+    if (capacity == 0) {
+        *size = SJA1105_StaticConfigSize(dev);
+        goto end;
+    }
+
+    status = SJA1105_SerialiseStaticConfig(dev, image, capacity, size);
+    if (status != SJA1105_OK) goto end;
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
+
+
+/* Same as SJA1105_ExportStaticConfig() but the image is passed to sink in parts as it is made, so no buffer is needed. sink
+ * is called with the mutex held. size is set to the total number of uint32_t passed to sink.
+ */
+sja1105_status_t SJA1105_ExportStaticConfigToSink(sja1105_handle_t *dev, sja1105_callback_export_t sink, void *context, uint32_t *size) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check the device is initialised and take the mutex */
+    SJA1105_LOCK;
+
+    /* Parameter checking */
+    if (!dev->initialised) status = SJA1105_NOT_CONFIGURED_ERROR;
+    if (sink == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) goto end;
+
+    status = SJA1105_SerialiseStaticConfigToSink(dev, sink, context, size);
+    if (status != SJA1105_OK) goto end;
+
+end:
+    SJA1105_UNLOCK;
+    return status;
+}
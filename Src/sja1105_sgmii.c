@@ -0,0 +1,119 @@
+/*
+ * sja1105_sgmii.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bens1
+ */
+
+#include "sja1105.h"
+#include "internal/sja1105_conf.h"
+#include "internal/sja1105_io.h"
+#include "internal/sja1105_regs.h"
+#include "internal/sja1105_tables.h"
+
+
+/* Check whether the device has an SGMII port and it is being used */
+bool SJA1105_SGMIIInUse(const sja1105_handle_t *dev) {
+    if ((dev->config->variant != VARIANT_SJA1105R) && (dev->config->variant != VARIANT_SJA1105S)) return false;
+    return dev->config->ports[SJA1105_SGMII_PORT].interface == SJA1105_INTERFACE_SGMII;
+}
+
+
+sja1105_status_t SJA1105_SGMIIRead(sja1105_handle_t *dev, uint32_t addr, uint16_t *value) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         reg_data;
+
+    status = SJA1105_ReadRegister(dev, addr, &reg_data, 1);
+    if (status != SJA1105_OK) return status;
+
+    *value = reg_data & SJA1105_SGMII_REG_MASK;
+
+    return status;
+}
+
+
+sja1105_status_t SJA1105_SGMIIWrite(sja1105_handle_t *dev, uint32_t addr, uint16_t value) {
+
+    uint32_t reg_data = value;
+
+    return SJA1105_WriteRegister(dev, addr, &reg_data, 1);
+}
+
+
+/* Set the speed of the PCS. SJA1105_SPEED_DYNAMIC enables autonegotiation, other speeds disable it and force the speed. The PCS
+ * stays powered down while the SGMII port is asleep.
+ */
+sja1105_status_t SJA1105_SGMIISetSpeed(sja1105_handle_t *dev, sja1105_speed_t speed) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint16_t         basic_control;
+
+    switch (speed) {
+        case SJA1105_SPEED_DYNAMIC:
+            basic_control = SJA1105_SGMII_BASIC_CONTROL_AN_ENABLE | SJA1105_SGMII_BASIC_CONTROL_AN_RESTART;
+            break;
+        case SJA1105_SPEED_1G:
+            basic_control = SJA1105_SGMII_BASIC_CONTROL_SPEED_1G | SJA1105_SGMII_BASIC_CONTROL_FULL_DUPLEX;
+            break;
+        case SJA1105_SPEED_100M:
+            basic_control = SJA1105_SGMII_BASIC_CONTROL_SPEED_100M | SJA1105_SGMII_BASIC_CONTROL_FULL_DUPLEX;
+            break;
+        case SJA1105_SPEED_10M:
+            basic_control = SJA1105_SGMII_BASIC_CONTROL_SPEED_10M | SJA1105_SGMII_BASIC_CONTROL_FULL_DUPLEX;
+            break;
+        default:
+            status = SJA1105_PARAMETER_ERROR;
+            break;
+    }
+    if (status != SJA1105_OK) return status;
+
+    if (dev->port_sleep.asleep & (1 << SJA1105_SGMII_PORT)) basic_control |= SJA1105_SGMII_BASIC_CONTROL_POWER_DOWN;
+
+    status = SJA1105_SGMIIWrite(dev, SJA1105_SGMII_REG_BASIC_CONTROL, basic_control);
+    if (status != SJA1105_OK) return status;
+
+    dev->sgmii_speed = speed;
+
+    return status;
+}
+
+
+/* Set up the PCS of the SGMII port as the MAC side of an SGMII link. The PCS is reset along with the rest of the switch so this
+ * must be done after every static config upload.
+ */
+sja1105_status_t SJA1105_ConfigureSGMII(sja1105_handle_t *dev) {
+
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_speed_t  mac_speed;
+
+    if (!SJA1105_SGMIIInUse(dev)) return status;
+
+    /* The MAC always runs at 1G, the PCS replicates symbols for lower speeds */
+    status = SJA1105_MACConfTableGetSpeed(&dev->tables.mac_configuration, SJA1105_SGMII_PORT, &mac_speed);
+    if (status != SJA1105_OK) return status;
+    if (mac_speed != SJA1105_SPEED_1G) {
+        status = SJA1105_MACConfTableSetSpeed(&dev->tables.mac_configuration, SJA1105_SGMII_PORT, SJA1105_SPEED_1G);
+        if (status != SJA1105_OK) return status;
+        status = SJA1105_MACConfTableWrite(dev, SJA1105_SGMII_PORT);
+        if (status != SJA1105_OK) return status;
+    }
+
+    /* Enable the vendor specific registers, let the PHY stop the clock during low power idle, follow the autonegotiated speed without software and flush the FIFOs */
+    status = SJA1105_SGMIIWrite(dev, SJA1105_SGMII_REG_DIGITAL_CONTROL_1, SJA1105_SGMII_DIGITAL_CONTROL_1_EN_VSMMD1 | SJA1105_SGMII_DIGITAL_CONTROL_1_CLOCK_STOP | SJA1105_SGMII_DIGITAL_CONTROL_1_MAC_AUTO_SW | SJA1105_SGMII_DIGITAL_CONTROL_1_INIT);
+    if (status != SJA1105_OK) return status;
+
+    /* No polarity inversion of the TX or RX lanes */
+    status = SJA1105_SGMIIWrite(dev, SJA1105_SGMII_REG_DIGITAL_CONTROL_2, SJA1105_SGMII_DIGITAL_CONTROL_2_TX_POL_INV_DISABLE);
+    if (status != SJA1105_OK) return status;
+
+    /* Use SGMII autonegotiation as the MAC side of the link */
+    status = SJA1105_SGMIIWrite(dev, SJA1105_SGMII_REG_AUTONEG_CONTROL, SJA1105_SGMII_AUTONEG_CONTROL_MODE_SGMII);
+    if (status != SJA1105_OK) return status;
+
+    /* Restore the speed, or autonegotiation */
+    status = SJA1105_SGMIISetSpeed(dev, dev->sgmii_speed);
+    if (status != SJA1105_OK) return status;
+
+    return status;
+}
@@ -53,40 +53,38 @@ sja1105_status_t SJA1105_ReadStaticConfFlags(sja1105_handle_t *dev, uint32_t *fl
 sja1105_status_t SJA1105_FreeAllTableMemory(sja1105_handle_t *dev) {
 
     sja1105_status_t status = SJA1105_OK;
-    sja1105_table_t  table;
+    sja1105_table_t *table;
 
     /* Go through each table */
     for (uint_fast8_t i = 0; i < SJA1105_NUM_TABLES; i++) {
-        table = dev->tables.by_index[i];
+        table = &dev->tables.by_index[i];
 
         /* Ignore unused tables */
-        if (!table.in_use) {
+        if (!table->in_use) {
             continue;
         }
 
         /* Free differently based on the type */
-        switch (SJA1105_GET_TABLE_LENGTH_TYPE(*table.id)) {
+        switch (SJA1105_GET_TABLE_LENGTH_TYPE(*table->id)) {
 
-            /* Fixed length tables don't need anything freed */
+            /* Fixed length tables only need their dirty bitmap freed */
             case SJA1105_TABLE_FIXED_LENGTH:
-                table.in_use         = false;
-                table.data_crc_valid = false;
                 break;
 
             /* Variable length tables need everything freed */
             case SJA1105_TABLE_VARIABLE_LENGTH:
-                status = dev->callbacks->callback_free(dev, (uint32_t *) table.id);
+                status = dev->callbacks->callback_free(dev, (uint32_t *) table->id);
                 if (status != SJA1105_OK) return status;
-                status = dev->callbacks->callback_free(dev, table.size);
+                status = dev->callbacks->callback_free(dev, table->size);
                 if (status != SJA1105_OK) return status;
-                status = dev->callbacks->callback_free(dev, table.header_crc);
+                status = dev->callbacks->callback_free(dev, table->header_crc);
                 if (status != SJA1105_OK) return status;
-                status = dev->callbacks->callback_free(dev, table.data);
+                if (!table->borrowed) {
+                    status = dev->callbacks->callback_free(dev, table->data);
+                    if (status != SJA1105_OK) return status;
+                }
+                status = dev->callbacks->callback_free(dev, table->data_crc);
                 if (status != SJA1105_OK) return status;
-                status = dev->callbacks->callback_free(dev, table.data_crc);
-                if (status != SJA1105_OK) return status;
-                table.in_use         = false;
-                table.data_crc_valid = false;
                 break;
 
             /* Invalid table ID */
@@ -95,6 +93,23 @@ sja1105_status_t SJA1105_FreeAllTableMemory(sja1105_handle_t *dev) {
                 return status;
                 break;
         }
+
+        /* Free the VLAN ID index (the ID has already been freed so use the table's index) */
+        if (i == SJA1105_GET_TABLE_INDEX(SJA1105_BLOCK_ID_VLAN_LOOKUP)) {
+            status = SJA1105_VLANIndexFree(dev);
+            if (status != SJA1105_OK) return status;
+        }
+
+        /* Free the dirty bitmap */
+        if (table->dirty != NULL) {
+            status = dev->callbacks->callback_free(dev, table->dirty);
+            if (status != SJA1105_OK) return status;
+            table->dirty = NULL;
+        }
+
+        table->in_use         = false;
+        table->data_crc_valid = false;
+        table->borrowed       = false;
     }
 
     /* Reset the fixed length table array */
@@ -106,32 +121,44 @@ sja1105_status_t SJA1105_FreeAllTableMemory(sja1105_handle_t *dev) {
 }
 
 
-sja1105_status_t SJA1105_AllocateFixedLengthTable(sja1105_handle_t *dev, const uint32_t *block, uint8_t block_size) {
+/* Allocate a table's dirty bitmap with every entry clean */
+sja1105_status_t SJA1105_AllocateDirtyBitmap(sja1105_handle_t *dev, sja1105_table_t *table, uint8_t id) {
 
-    sja1105_status_t   status = SJA1105_OK;
-    sja1105_block_id_t id;
-    uint32_t           size;
-    uint32_t           header_crc;
-    uint32_t           data_crc;
-    sja1105_table_t   *table;
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         size   = SJA1105_DIRTY_BITMAP_SIZE(id);
 
-    /* Check table isn't already in use */
-    id    = (block[SJA1105_STATIC_CONF_BLOCK_ID_OFFSET] & SJA1105_STATIC_CONF_BLOCK_ID_MASK) >> SJA1105_STATIC_CONF_BLOCK_ID_SHIFT;
-    table = &dev->tables.by_index[SJA1105_GET_TABLE_INDEX(id)];
-    if (table->in_use) status = SJA1105_ALREADY_CONFIGURED_ERROR;
+    /* Check the bitmap isn't already allocated */
+    if (table->dirty != NULL) status = SJA1105_DYNAMIC_MEMORY_ERROR;
+    if (size == 0) status = SJA1105_PARAMETER_ERROR;
     if (status != SJA1105_OK) return status;
 
-    /* Check size argument */
-    size = (block[SJA1105_STATIC_CONF_BLOCK_SIZE_OFFSET] & SJA1105_STATIC_CONF_BLOCK_SIZE_MASK) >> SJA1105_STATIC_CONF_BLOCK_SIZE_SHIFT;
-    if (block_size != (size + SJA1105_STATIC_CONF_BLOCK_OVERHEAD)) status = SJA1105_STATIC_CONF_ERROR;
+    status = dev->callbacks->callback_allocate(dev, &table->dirty, size);
     if (status != SJA1105_OK) return status;
+    memset(table->dirty, 0, size * sizeof(uint32_t));
+
+    return status;
+}
+
+
+/* Check the header and data CRCs of a block, calculating any that are left at 0. If the config trusts the CRCs and the block
+ * has both they are used without being checked.
+ */
+static sja1105_status_t SJA1105_CheckBlockCRCs(sja1105_handle_t *dev, const uint32_t *block, uint32_t block_size, uint32_t *header_crc, uint32_t *data_crc) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         size   = block_size - SJA1105_STATIC_CONF_BLOCK_OVERHEAD;
+
+    /* Use the CRCs as they are */
+    *header_crc = block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET];
+    *data_crc   = block[block_size - 1];
+    if (dev->config->trust_crcs && (*header_crc != 0) && (*data_crc != 0)) return status;
 
     /* Check header CRC */
     status = dev->callbacks->callback_crc_reset(dev);
     if (status != SJA1105_OK) return status;
-    status = dev->callbacks->callback_crc_accumulate(dev, block, SJA1105_STATIC_CONF_BLOCK_HEADER, &header_crc);
+    status = dev->callbacks->callback_crc_accumulate(dev, block, SJA1105_STATIC_CONF_BLOCK_HEADER, header_crc);
     if (status != SJA1105_OK) return status;
-    if ((header_crc != block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET]) && (block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET] != 0)) {
+    if ((*header_crc != block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET]) && (block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET] != 0)) {
         status = SJA1105_CRC_ERROR;
         dev->events.crc_errors++;
         return status;
@@ -140,14 +167,61 @@ sja1105_status_t SJA1105_AllocateFixedLengthTable(sja1105_handle_t *dev, const u
     /* Check data CRC */
     status = dev->callbacks->callback_crc_reset(dev);
     if (status != SJA1105_OK) return status;
-    status = dev->callbacks->callback_crc_accumulate(dev, block + SJA1105_STATIC_CONF_DATA_OFFSET, size, &data_crc);
+    status = dev->callbacks->callback_crc_accumulate(dev, block + SJA1105_STATIC_CONF_DATA_OFFSET, size, data_crc);
     if (status != SJA1105_OK) return status;
-    if ((data_crc != block[block_size - 1]) && (block[block_size - 1] != 0)) {
+    if ((*data_crc != block[block_size - 1]) && (block[block_size - 1] != 0)) {
         status = SJA1105_CRC_ERROR;
         dev->events.crc_errors++;
         return status;
     }
 
+    return status;
+}
+
+
+/* Number of uint32_t to allocate for a variable length table's data. Tables that can grow have space left after them, up to
+ * the size of a full table
+ */
+static uint32_t SJA1105_TableCapacity(uint8_t id, uint32_t size) {
+
+    uint32_t capacity = size;
+
+    if ((id == SJA1105_BLOCK_ID_VLAN_LOOKUP) && (size < (SJA1105_NUM_VLAN_IDS * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE))) {
+        capacity = CONSTRAIN(size + (SJA1105_VLAN_LOOKUP_HEADROOM * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE), size, SJA1105_NUM_VLAN_IDS * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE);
+    }
+
+    return capacity;
+}
+
+
+sja1105_status_t SJA1105_AllocateFixedLengthTable(sja1105_handle_t *dev, const uint32_t *block, uint32_t block_size) {
+
+    sja1105_status_t   status = SJA1105_OK;
+    sja1105_block_id_t id;
+    uint32_t           size;
+    uint32_t           header_crc;
+    uint32_t           data_crc;
+    sja1105_table_t   *table;
+
+    /* Check table isn't already in use */
+    id    = (block[SJA1105_STATIC_CONF_BLOCK_ID_OFFSET] & SJA1105_STATIC_CONF_BLOCK_ID_MASK) >> SJA1105_STATIC_CONF_BLOCK_ID_SHIFT;
+    table = &dev->tables.by_index[SJA1105_GET_TABLE_INDEX(id)];
+    if (table->in_use) status = SJA1105_ALREADY_CONFIGURED_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Check size argument */
+    size = (block[SJA1105_STATIC_CONF_BLOCK_SIZE_OFFSET] & SJA1105_STATIC_CONF_BLOCK_SIZE_MASK) >> SJA1105_STATIC_CONF_BLOCK_SIZE_SHIFT;
+    if (block_size != (size + SJA1105_STATIC_CONF_BLOCK_OVERHEAD)) status = SJA1105_STATIC_CONF_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Check the block fits in the fixed length table buffer */
+    if ((dev->tables.first_free + block_size) > (dev->tables.device_id + SJA1105_FIXED_BUFFER_SIZE)) status = SJA1105_STATIC_CONF_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Check the CRCs */
+    status = SJA1105_CheckBlockCRCs(dev, block, block_size, &header_crc, &data_crc);
+    if (status != SJA1105_OK) return status;
+
     /* Setup the pointers */
     table->id         = ((uint8_t *) dev->tables.first_free) + 3;
     table->size       = dev->tables.first_free + SJA1105_STATIC_CONF_BLOCK_SIZE_OFFSET;
@@ -158,6 +232,7 @@ sja1105_status_t SJA1105_AllocateFixedLengthTable(sja1105_handle_t *dev, const u
     /* Copy in the block and advance the free pointer */
     memcpy(dev->tables.first_free, block, block_size * sizeof(uint32_t));
     dev->tables.first_free += block_size;
+    table->capacity         = size;
 
     /* Write the CRCs if none were provided */
     if (block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET] == 0) *table->header_crc = header_crc;
@@ -168,6 +243,10 @@ sja1105_status_t SJA1105_AllocateFixedLengthTable(sja1105_handle_t *dev, const u
     if (*table->size != size) status = SJA1105_MEMORY_ERROR;
     if (status != SJA1105_OK) return status;
 
+    /* Allocate the dirty bitmap */
+    status = SJA1105_AllocateDirtyBitmap(dev, table, id);
+    if (status != SJA1105_OK) return status;
+
     /* Set the flags in the entry */
     table->in_use         = true;
     table->data_crc_valid = true;
@@ -176,11 +255,15 @@ sja1105_status_t SJA1105_AllocateFixedLengthTable(sja1105_handle_t *dev, const u
 }
 
 
-sja1105_status_t SJA1105_AllocateVariableLengthTable(sja1105_handle_t *dev, const uint32_t *block, uint8_t block_size) {
+/* Allocate a variable length table and copy the block into it. If borrow is true the table's data points into the block
+ * instead, which must then stay valid until the table is freed or made writable
+ */
+sja1105_status_t SJA1105_AllocateVariableLengthTable(sja1105_handle_t *dev, const uint32_t *block, uint32_t block_size, bool borrow) {
 
     sja1105_status_t   status     = SJA1105_OK;
     sja1105_block_id_t id         = 0xff;
     uint32_t           size       = 0;
+    uint32_t           capacity   = 0;
     uint32_t           header_crc = 0;
     uint32_t           data_crc   = 0;
     sja1105_table_t   *table      = NULL;
@@ -196,27 +279,12 @@ sja1105_status_t SJA1105_AllocateVariableLengthTable(sja1105_handle_t *dev, cons
     if (block_size != (size + SJA1105_STATIC_CONF_BLOCK_OVERHEAD)) status = SJA1105_STATIC_CONF_ERROR;
     if (status != SJA1105_OK) return status;
 
-    /* Check header CRC */
-    status = dev->callbacks->callback_crc_reset(dev);
+    /* Check the CRCs */
+    status = SJA1105_CheckBlockCRCs(dev, block, block_size, &header_crc, &data_crc);
     if (status != SJA1105_OK) return status;
-    status = dev->callbacks->callback_crc_accumulate(dev, block, SJA1105_STATIC_CONF_BLOCK_HEADER, &header_crc);
-    if (status != SJA1105_OK) return status;
-    if ((header_crc != block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET]) && (block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET] != 0)) {
-        status = SJA1105_CRC_ERROR;
-        dev->events.crc_errors++;
-        return status;
-    }
 
-    /* Check data CRC */
-    status = dev->callbacks->callback_crc_reset(dev);
-    if (status != SJA1105_OK) return status;
-    status = dev->callbacks->callback_crc_accumulate(dev, block + SJA1105_STATIC_CONF_DATA_OFFSET, size, &data_crc);
-    if (status != SJA1105_OK) return status;
-    if ((data_crc != block[block_size - 1]) && (block[block_size - 1] != 0)) {
-        status = SJA1105_CRC_ERROR;
-        dev->events.crc_errors++;
-        return status;
-    }
+    /* Leave space after tables that can grow. In zero copy mode the data stays in the static config until it is changed */
+    capacity = borrow ? size : SJA1105_TableCapacity(id, size);
 
     /* Allocate the memory */
     status = dev->callbacks->callback_allocate(dev, (uint32_t **) &table->id, SJA1105_STATIC_CONF_BLOCK_ID);
@@ -225,22 +293,116 @@ sja1105_status_t SJA1105_AllocateVariableLengthTable(sja1105_handle_t *dev, cons
     if (status != SJA1105_OK) return status;
     status = dev->callbacks->callback_allocate(dev, &table->header_crc, SJA1105_STATIC_CONF_BLOCK_HEADER_CRC);
     if (status != SJA1105_OK) return status;
-    status = dev->callbacks->callback_allocate(dev, &table->data, size);
-    if (status != SJA1105_OK) return status;
+    if (borrow) {
+        table->data     = (uint32_t *) (block + SJA1105_STATIC_CONF_DATA_OFFSET);
+        table->borrowed = true;
+    } else {
+        status = dev->callbacks->callback_allocate(dev, &table->data, capacity);
+        if (status != SJA1105_OK) return status;
+    }
+    table->capacity = capacity;
     status = dev->callbacks->callback_allocate(dev, &table->data_crc, SJA1105_STATIC_CONF_BLOCK_DATA_CRC);
     if (status != SJA1105_OK) return status;
+    status = SJA1105_AllocateDirtyBitmap(dev, table, id);
+    if (status != SJA1105_OK) return status;
 
     /* Copy in the values */
     *table->id         = id;
     *table->size       = size;
     *table->header_crc = (block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET] != 0) ? block[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET] : header_crc;
-    memcpy(table->data, block + SJA1105_STATIC_CONF_DATA_OFFSET, size);
+    if (!table->borrowed) memcpy(table->data, block + SJA1105_STATIC_CONF_DATA_OFFSET, size * sizeof(uint32_t));
     *table->data_crc = (block[block_size - 1] != 0) ? block[block_size - 1] : data_crc;
 
-    /* Set the flags in the entry */
+    /* Set the flags in the entry. The table is in use before it is indexed so SJA1105_FreeAllTableMemory() frees it (and any
+     * partial index) if indexing fails
+     */
     table->in_use         = true;
     table->data_crc_valid = true;
 
+    /* Index the VLAN lookup table by VLAN ID */
+    if (id == SJA1105_BLOCK_ID_VLAN_LOOKUP) {
+        status = SJA1105_VLANIndexBuild(dev);
+        if (status != SJA1105_OK) return status;
+    }
+
+    return status;
+}
+
+
+/* Copy a table that still points into the static config to RAM so it can be changed. Does nothing if it is already in RAM */
+sja1105_status_t SJA1105_TableMakeWritable(sja1105_handle_t *dev, sja1105_table_t *table) {
+
+    sja1105_status_t status   = SJA1105_OK;
+    uint32_t        *data     = NULL;
+    uint32_t         capacity = 0;
+
+    if (!table->borrowed) return status;
+
+    capacity = SJA1105_TableCapacity(*table->id, *table->size);
+    status   = dev->callbacks->callback_allocate(dev, &data, capacity);
+    if (status != SJA1105_OK) return status;
+    memcpy(data, table->data, *table->size * sizeof(uint32_t));
+    table->data     = data;
+    table->capacity = capacity;
+    table->borrowed = false;
+    dev->events.tables_copied++;
+
+    return status;
+}
+
+
+/* Check a complete block (including its header and CRCs) and store it in its table */
+sja1105_status_t SJA1105_LoadBlock(sja1105_handle_t *dev, const uint32_t *block, uint32_t block_size, bool borrow) {
+
+    sja1105_status_t   status = SJA1105_OK;
+    sja1105_block_id_t id     = (block[SJA1105_STATIC_CONF_BLOCK_ID_OFFSET] & SJA1105_STATIC_CONF_BLOCK_ID_MASK) >> SJA1105_STATIC_CONF_BLOCK_ID_SHIFT;
+
+    /* Check blocks before copying them */
+    status = SJA1105_CheckTable(dev, id, block + SJA1105_STATIC_CONF_DATA_OFFSET, block_size - SJA1105_STATIC_CONF_BLOCK_OVERHEAD);
+    if (status != SJA1105_OK) return status;
+
+    /* Allocate and store the table */
+    switch (SJA1105_GET_TABLE_LENGTH_TYPE(id)) {
+
+        case SJA1105_TABLE_FIXED_LENGTH:
+            status = SJA1105_AllocateFixedLengthTable(dev, block, block_size);
+            break;
+
+        case SJA1105_TABLE_VARIABLE_LENGTH:
+            status = SJA1105_AllocateVariableLengthTable(dev, block, block_size, borrow);
+            break;
+
+        default:
+            break;
+    }
+
+    return status;
+}
+
+
+/* Once every block is loaded, check the required tables are present and add the CGU, ACU and port settings */
+sja1105_status_t SJA1105_LoadStaticConfigFinish(sja1105_handle_t *dev) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    /* Check all required tables are present and agree with each other */
+    status = SJA1105_CheckRequiredTables(dev);
+    if (status != SJA1105_OK) return status;
+    status = SJA1105_CheckTableConsistency(dev);
+    if (status != SJA1105_OK) return status;
+
+    /* Add the CGU config */
+    status = SJA1105_ConfigureCGU(dev, false);
+    if (status != SJA1105_OK) return status;
+
+    /* Add the ACU config */
+    status = SJA1105_ConfigureACU(dev, false);
+    if (status != SJA1105_OK) return status;
+
+    /* Reset ingress, egress and learning in MAC config table based SJA1105_PORTS_START_ENABLED */
+    status = SJA1105_ResetMACConfTable(dev, false);
+    if (status != SJA1105_OK) return status;
+
     return status;
 }
 
@@ -266,9 +428,12 @@ sja1105_status_t SJA1105_LoadStaticConfig(sja1105_handle_t *dev, const uint32_t
     uint32_t           block_index       = SJA1105_STATIC_CONF_BLOCK_FIRST_OFFSET; /* Index of static_conf_size used for the start of the current block. Starts at 1 because the SWITCH_CORE_ID comes first. */
     uint32_t           block_index_next  = 0;
     sja1105_block_id_t block_id          = 0;
-    uint16_t           block_size        = 0; /* Block size listed in the static config */
-    uint16_t           block_size_actual = 0; /* Actual block size including headers and CRCs */
+    uint32_t           block_size        = 0; /* Block size listed in the static config */
+    uint32_t           block_size_actual = 0; /* Actual block size including headers and CRCs */
     bool               last_block        = false;
+    uint8_t            num_blocks        = 0;    /* Number of tables loaded from the static config */
+    uint8_t            next_index        = 0;    /* Lowest table index the next block can have to be in the order SJA1105_WriteStaticConfig() writes them */
+    bool               in_order          = true;
 
     do {
 
@@ -299,46 +464,36 @@ sja1105_status_t SJA1105_LoadStaticConfig(sja1105_handle_t *dev, const uint32_t
             if (status != SJA1105_OK) return status;
         }
 
-        /* Check blocks before copying them */
-        status = SJA1105_CheckTable(dev, block_id, static_conf + block_index + SJA1105_STATIC_CONF_BLOCK_HEADER + SJA1105_STATIC_CONF_BLOCK_HEADER_CRC, block_size);
+        /* Check and store the block */
+        status = SJA1105_LoadBlock(dev, static_conf + block_index, block_size_actual, dev->config->zero_copy);
         if (status != SJA1105_OK) return status;
 
-        /* Allocate and store the table */
-        switch (SJA1105_GET_TABLE_LENGTH_TYPE(block_id)) {
-
-            case SJA1105_TABLE_FIXED_LENGTH:
-                status = SJA1105_AllocateFixedLengthTable(dev, static_conf + block_index, block_size_actual);
-                break;
-
-            case SJA1105_TABLE_VARIABLE_LENGTH:
-                status = SJA1105_AllocateVariableLengthTable(dev, static_conf + block_index, block_size_actual);
-                break;
-
-            default:
-                break;
-        }
-        if (status != SJA1105_OK) return status;
+        /* Keep track of whether the image can keep its global CRC */
+        if (SJA1105_GET_TABLE_INDEX(block_id) < next_index) in_order = false;
+        next_index = SJA1105_GET_TABLE_INDEX(block_id) + 1;
+        num_blocks++;
 
         /* Set the block index for the next block */
         block_index = block_index_next;
 
     } while (!last_block);
 
-    /* Check all required tables are present */
-    status = SJA1105_CheckRequiredTables(dev);
-    if (status != SJA1105_OK) return status;
-
-    /* Add the CGU config */
-    status = SJA1105_ConfigureCGU(dev, false);
-    if (status != SJA1105_OK) return status;
-
-    /* Add the ACU config */
-    status = SJA1105_ConfigureACU(dev, false);
+    /* Check the tables and apply the port configuration */
+    status = SJA1105_LoadStaticConfigFinish(dev);
     if (status != SJA1105_OK) return status;
 
-    /* Reset ingress, egress and learning in MAC config table based SJA1105_PORTS_START_ENABLED */
-    status = SJA1105_ResetMACConfTable(dev, false);
-    if (status != SJA1105_OK) return status;
+    /* A trusted image that already had every table in order, and wasn't changed above, keeps its global CRC */
+    if (dev->config->trust_crcs && in_order && (static_conf[static_conf_size - 1] != 0)) {
+        for (uint_fast8_t i = 0; i < SJA1105_NUM_TABLES; i++) {
+            if (!dev->tables.by_index[i].in_use) continue;
+            if (!dev->tables.by_index[i].data_crc_valid) in_order = false;
+            num_blocks--;
+        }
+        if (in_order && (num_blocks == 0)) {
+            dev->tables.global_crc       = static_conf[static_conf_size - 1];
+            dev->tables.global_crc_valid = true;
+        }
+    }
 
     return status;
 }
@@ -362,8 +517,8 @@ sja1105_status_t SJA1105_WriteStaticConfig(sja1105_handle_t *dev, bool safe) {
 
         table = &dev->tables.by_index[table_i];
 
-        /* Calculate the CRC. Don't rely on a pre-computed CRCs in safe mode */
-        if (table->in_use && (!table->data_crc_valid || safe)) {
+        /* Calculate the CRC. Don't rely on a pre-computed CRCs in safe mode unless the config trusts them */
+        if (table->in_use && (!table->data_crc_valid || (safe && !dev->config->trust_crcs))) {
             dev->tables.global_crc_valid = false;
             status                       = dev->callbacks->callback_crc_reset(dev);
             if (status != SJA1105_OK) return status;
@@ -445,9 +600,25 @@ sja1105_status_t SJA1105_WriteStaticConfig(sja1105_handle_t *dev, bool safe) {
         status = dev->callbacks->callback_crc_accumulate(dev, end_block, SJA1105_STATIC_CONF_BLOCK_LAST_SIZE - 1, &crc_value);
         if (status != SJA1105_OK) return status;
         end_block[SJA1105_STATIC_CONF_BLOCK_LAST_SIZE - 1] = crc_value;
+        dev->tables.global_crc                             = crc_value;
         dev->tables.global_crc_valid                       = true;
     }
 
+    /* Write the last block */
+    status = SJA1105_WriteLastBlock(dev, offset, end_block[SJA1105_STATIC_CONF_BLOCK_LAST_SIZE - 1]);
+    if (status != SJA1105_OK) return status;
+
+    return status;
+}
+
+
+/* Write the last block of the static config at offset and check the device accepted the whole config */
+sja1105_status_t SJA1105_WriteLastBlock(sja1105_handle_t *dev, uint32_t offset, uint32_t global_crc) {
+
+    sja1105_status_t status                                         = SJA1105_OK;
+    uint32_t         end_block[SJA1105_STATIC_CONF_BLOCK_LAST_SIZE] = {0, 0, global_crc};
+    uint32_t         reg_data                                       = 0;
+
     /* Write the last block */
     status = SJA1105_WriteRegister(dev, SJA1105_STATIC_CONF_ADDR + offset, end_block, SJA1105_STATIC_CONF_BLOCK_LAST_SIZE);
     if (status != SJA1105_OK) return status;
@@ -473,12 +644,143 @@ sja1105_status_t SJA1105_WriteStaticConfig(sja1105_handle_t *dev, bool safe) {
 }
 
 
+/* Number of uint32_t needed to hold the tables in the generic loader format */
+uint32_t SJA1105_StaticConfigSize(const sja1105_handle_t *dev) {
+
+    uint32_t size = SJA1105_STATIC_CONF_BLOCK_FIRST_OFFSET + SJA1105_STATIC_CONF_BLOCK_LAST_SIZE; /* Device ID and last block */
+
+    for (uint_fast8_t i = 0; i < SJA1105_NUM_TABLES; i++) {
+        if (dev->tables.by_index[i].in_use) size += SJA1105_STATIC_CONF_BLOCK_OVERHEAD + *dev->tables.by_index[i].size;
+    }
+
+    return size;
+}
+
+
+/* Pass the tables to sink in the generic loader format, calculating any CRCs that aren't valid. Tables are in the same order
+ * as SJA1105_WriteStaticConfig() writes them, so the image can be loaded with sja1105_config_t.trust_crcs set. size is set to
+ * the number of uint32_t passed to sink.
+ */
+sja1105_status_t SJA1105_SerialiseStaticConfigToSink(sja1105_handle_t *dev, sja1105_callback_export_t sink, void *context, uint32_t *size) {
+
+    sja1105_status_t status                                         = SJA1105_OK;
+    sja1105_table_t *table                                          = NULL;
+    uint32_t         header[SJA1105_STATIC_CONF_DATA_OFFSET];
+    uint32_t         end_block[SJA1105_STATIC_CONF_BLOCK_LAST_SIZE] = {0, 0, 0};
+    uint32_t         offset                                         = 0;
+    uint32_t         crc_value                                      = 0;
+
+    /* Calculate the data CRCs that have changed first, so the global CRC can be accumulated in one pass */
+    for (uint_fast8_t i = 0; i < SJA1105_NUM_TABLES; i++) {
+
+        table = &dev->tables.by_index[i];
+        if (!table->in_use || table->data_crc_valid) continue;
+
+        status = dev->callbacks->callback_crc_reset(dev);
+        if (status != SJA1105_OK) return status;
+        status = dev->callbacks->callback_crc_accumulate(dev, table->data, *table->size, &crc_value);
+        if (status != SJA1105_OK) return status;
+        *table->data_crc      = crc_value;
+        table->data_crc_valid = true;
+    }
+
+    /* Device ID */
+    status = dev->callbacks->callback_crc_reset(dev);
+    if (status != SJA1105_OK) return status;
+    status = dev->callbacks->callback_crc_accumulate(dev, dev->tables.device_id, 1, &crc_value);
+    if (status != SJA1105_OK) return status;
+    status = sink(dev, dev->tables.device_id, 1, context);
+    if (status != SJA1105_OK) return status;
+    offset = SJA1105_STATIC_CONF_BLOCK_FIRST_OFFSET;
+
+    for (uint_fast8_t i = 0; i < SJA1105_NUM_TABLES; i++) {
+
+        table = &dev->tables.by_index[i];
+        if (!table->in_use) continue;
+
+        header[SJA1105_STATIC_CONF_BLOCK_ID_OFFSET]   = ((uint32_t) *table->id) << SJA1105_STATIC_CONF_BLOCK_ID_SHIFT;
+        header[SJA1105_STATIC_CONF_BLOCK_SIZE_OFFSET] = (*table->size << SJA1105_STATIC_CONF_BLOCK_SIZE_SHIFT) & SJA1105_STATIC_CONF_BLOCK_SIZE_MASK;
+        header[SJA1105_STATIC_CONF_HEADER_CRC_OFFSET] = *table->header_crc;
+
+        /* Add the block to the global CRC */
+        status = dev->callbacks->callback_crc_accumulate(dev, header, SJA1105_STATIC_CONF_DATA_OFFSET, &crc_value);
+        if (status != SJA1105_OK) return status;
+        status = dev->callbacks->callback_crc_accumulate(dev, table->data, *table->size, &crc_value);
+        if (status != SJA1105_OK) return status;
+        status = dev->callbacks->callback_crc_accumulate(dev, table->data_crc, SJA1105_STATIC_CONF_BLOCK_DATA_CRC, &crc_value);
+        if (status != SJA1105_OK) return status;
+
+        /* Pass on the block */
+        status = sink(dev, header, SJA1105_STATIC_CONF_DATA_OFFSET, context);
+        if (status != SJA1105_OK) return status;
+        status = sink(dev, table->data, *table->size, context);
+        if (status != SJA1105_OK) return status;
+        status = sink(dev, table->data_crc, SJA1105_STATIC_CONF_BLOCK_DATA_CRC, context);
+        if (status != SJA1105_OK) return status;
+        offset += SJA1105_STATIC_CONF_BLOCK_OVERHEAD + *table->size;
+    }
+
+    /* Last block, the global CRC covers everything before it */
+    status = dev->callbacks->callback_crc_accumulate(dev, end_block, SJA1105_STATIC_CONF_BLOCK_LAST_SIZE - 1, &crc_value);
+    if (status != SJA1105_OK) return status;
+    end_block[SJA1105_STATIC_CONF_BLOCK_LAST_SIZE - 1] = crc_value;
+    status                                             = sink(dev, end_block, SJA1105_STATIC_CONF_BLOCK_LAST_SIZE, context);
+    if (status != SJA1105_OK) return status;
+    dev->tables.global_crc       = crc_value;
+    dev->tables.global_crc_valid = true;
+
+    *size = offset + SJA1105_STATIC_CONF_BLOCK_LAST_SIZE;
+
+    return status;
+}
+
+
+/* Where SJA1105_SerialiseStaticConfig() has got to in the image */
+typedef struct {
+    uint32_t *image;
+    uint32_t  offset;
+} sja1105_serialise_buffer_t;
+
+
+static sja1105_status_t SJA1105_SerialiseToBuffer(sja1105_handle_t *dev, const uint32_t *data, uint32_t size, void *context) {
+
+    sja1105_serialise_buffer_t *buffer = context;
+
+    (void) dev;
+
+    memcpy(buffer->image + buffer->offset, data, size * sizeof(uint32_t));
+    buffer->offset += size;
+
+    return SJA1105_OK;
+}
+
+
+/* Write the tables into image in the generic loader format, see SJA1105_SerialiseStaticConfigToSink(). If the image doesn't
+ * fit then nothing is written and size is set to the number of uint32_t needed.
+ */
+sja1105_status_t SJA1105_SerialiseStaticConfig(sja1105_handle_t *dev, uint32_t *image, uint32_t capacity, uint32_t *size) {
+
+    sja1105_status_t           status = SJA1105_OK;
+    sja1105_serialise_buffer_t buffer = {.image = image, .offset = 0};
+
+    /* Check the image fits */
+    *size = SJA1105_StaticConfigSize(dev);
+    if (*size > capacity) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    status = SJA1105_SerialiseStaticConfigToSink(dev, SJA1105_SerialiseToBuffer, &buffer, size);
+    if (status != SJA1105_OK) return status;
+
+    return status;
+}
+
+
 sja1105_status_t SJA1105_CheckRequiredTables(sja1105_handle_t *dev) {
 
     sja1105_status_t status = SJA1105_OK;
 
     /* Check if any required tables are missing */
-    if (!dev->tables.l2_policing.in_use || dev->tables.l2_policing.size == 0) status = SJA1105_MISSING_TABLE_ERROR;
+    if (!dev->tables.l2_policing.in_use || *dev->tables.l2_policing.size == 0) status = SJA1105_MISSING_TABLE_ERROR;
     if (!dev->tables.l2_forwarding.in_use) status = SJA1105_MISSING_TABLE_ERROR;
     if (!dev->tables.l2_forwarding_parameters.in_use) status = SJA1105_MISSING_TABLE_ERROR;
     if (!dev->tables.mac_configuration.in_use) status = SJA1105_MISSING_TABLE_ERROR;
@@ -486,9 +788,10 @@ sja1105_status_t SJA1105_CheckRequiredTables(sja1105_handle_t *dev) {
     if (!dev->tables.xmii_mode_parameters.in_use) status = SJA1105_MISSING_TABLE_ERROR;
 
     /* Check table dependencies */
-    if (!dev->tables.schedule_entry_point_parameters.in_use && dev->tables.schedule.in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (!dev->tables.schedule_entry_points.in_use && dev->tables.schedule.in_use) status = SJA1105_MISSING_TABLE_ERROR;
     if (!dev->tables.schedule_parameters.in_use && dev->tables.schedule.in_use) status = SJA1105_MISSING_TABLE_ERROR;
     if (!dev->tables.schedule_entry_point_parameters.in_use && dev->tables.schedule.in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (!dev->tables.schedule.in_use && dev->tables.schedule_entry_points.in_use) status = SJA1105_MISSING_TABLE_ERROR;
     if (!dev->tables.vl_forwarding_parameters.in_use && dev->tables.vl_forwarding.in_use) status = SJA1105_MISSING_TABLE_ERROR;
 
     /* TODO: Check if VL Policing and forwarding tables are present if VL lookup is and has any critical entries */
@@ -497,11 +800,53 @@ sja1105_status_t SJA1105_CheckRequiredTables(sja1105_handle_t *dev) {
 }
 
 
+/* Check the fields that refer to other tables, so a config the switch would reject is caught before it is uploaded. Each
+ * table has already been checked on its own by SJA1105_CheckTable().
+ */
+sja1105_status_t SJA1105_CheckTableConsistency(sja1105_handle_t *dev) {
+
+    sja1105_status_t status       = SJA1105_OK;
+    uint32_t         memory       = 0;
+    uint32_t         memory_limit = SJA1105_FRAME_MEMORY_SIZE;
+    uint32_t         mirror       = 0;
+    uint8_t          mirr_port;
+
+    /* The L2 and VL partitions share the frame memory, less some for retagging */
+    for (uint_fast8_t i = 0; i < SJA1105_NUM_PARTITIONS; i++) {
+        memory += SJA1105_TableGetField(dev->tables.l2_forwarding_parameters.data, SJA1105_STATIC_CONF_L2_FORWARDING_PARAMS_PART_SPC(i), SJA1105_STATIC_CONF_PART_SPC_WIDTH);
+        if (dev->tables.vl_forwarding_parameters.in_use) {
+            memory += SJA1105_TableGetField(dev->tables.vl_forwarding_parameters.data, SJA1105_STATIC_CONF_VL_FORWARDING_PARAMS_PARTSPC(i), SJA1105_STATIC_CONF_PART_SPC_WIDTH);
+        }
+    }
+    if (dev->tables.retagging.in_use) memory_limit -= SJA1105_FRAME_MEMORY_RETAGGING_OVERHEAD;
+    if (memory > memory_limit) status = SJA1105_STATIC_CONF_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* VLANs and ports that mirror frames need a mirror port */
+    for (uint32_t i = 0; dev->tables.vlan_lookup.in_use && (i < *dev->tables.vlan_lookup.size); i += SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE) {
+        mirror |= dev->tables.vlan_lookup.data[i + 1] & (SJA1105_STATIC_CONF_VLAN_LOOKUP_VEGR_MIRR_MASK | SJA1105_STATIC_CONF_VLAN_LOOKUP_VING_MIRR_MASK);
+    }
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        mirror |= SJA1105_TableGetField(dev->tables.mac_configuration.data + SJA1105_STATIC_CONF_MAC_CONF_BASE(port_num), SJA1105_STATIC_CONF_MAC_CONF_EGR_MIRR, 1);
+        mirror |= SJA1105_TableGetField(dev->tables.mac_configuration.data + SJA1105_STATIC_CONF_MAC_CONF_BASE(port_num), SJA1105_STATIC_CONF_MAC_CONF_ING_MIRR, 1);
+    }
+    mirr_port = (dev->tables.general_parameters.data[SJA1105_STATIC_CONF_GENERAL_PARAMS_MIRR_PORT_OFFSET] & SJA1105_STATIC_CONF_GENERAL_PARAMS_MIRR_PORT_MASK) >> SJA1105_STATIC_CONF_GENERAL_PARAMS_MIRR_PORT_SHIFT;
+    if (mirror && (mirr_port >= SJA1105_NUM_PORTS)) status = SJA1105_STATIC_CONF_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    return status;
+}
+
+
 /* Sync the states of the driver and the chip by reuploading the static config (note this flushes learned MAC addresses) */
 sja1105_status_t SJA1105_SyncStaticConfig(sja1105_handle_t *dev) {
 
     sja1105_status_t status = SJA1105_OK;
 
+    /* The shadow tables may have been changed since they were loaded, so check them again before the switch is reset */
+    status = SJA1105_CheckTableConsistency(dev);
+    if (status != SJA1105_OK) return status;
+
     /* Free management routes */
     if (dev->initialised) {
 
@@ -522,16 +867,49 @@ sja1105_status_t SJA1105_SyncStaticConfig(sja1105_handle_t *dev) {
     /* Write the configuration and try again in safe mode if it fails */
     status = SJA1105_WriteStaticConfig(dev, true); /* TODO: Change to false when unsafe mode is fixed */
     if (status == SJA1105_CRC_ERROR) {
+
+        /* Don't trust any CRCs the second time */
+        if (dev->config->trust_crcs) {
+            for (uint_fast8_t i = 0; i < SJA1105_NUM_TABLES; i++) {
+                if (!dev->tables.by_index[i].in_use) continue;
+                status = SJA1105_TableSetSize(dev, &dev->tables.by_index[i], *dev->tables.by_index[i].size); /* Recalculates the header CRC */
+                if (status != SJA1105_OK) return status;
+                dev->tables.by_index[i].data_crc_valid = false;
+            }
+            dev->tables.global_crc_valid = false;
+        }
         status = SJA1105_WriteStaticConfig(dev, true);
     }
     if (status != SJA1105_OK) return status;
 
+    /* Set up everything the static config doesn't cover */
+    status = SJA1105_FinishStaticConfigUpload(dev);
+    if (status != SJA1105_OK) return status;
+
+    return status;
+}
+
+
+/* Called once the device has accepted a static config upload */
+sja1105_status_t SJA1105_FinishStaticConfigUpload(sja1105_handle_t *dev) {
+
+    sja1105_status_t status = SJA1105_OK;
+
     /* Configure the CGU. Note this was done previously in SJA1105_LoadStaticConfig()
      * and then loaded in SJA1105_WriteStaticConfig(), however it doesn't work when done
      * through static tables for some reason. TODO: Find out why */
     status = SJA1105_ConfigureCGU(dev, true);
     if (status != SJA1105_OK) return status;
 
+    /* The SGMII PCS was reset with the switch so set it up again */
+    status = SJA1105_ConfigureSGMII(dev);
+    if (status != SJA1105_OK) return status;
+
+    /* The device now matches every shadow table */
+    for (uint_fast8_t i = 0; i < SJA1105_NUM_TABLES; i++) {
+        if (dev->tables.by_index[i].in_use) SJA1105_TableMarkAllClean(&dev->tables.by_index[i]);
+    }
+
     /* Set the device to initialised again and increment the static config upload count */
     dev->initialised = true;
     dev->events.static_conf_uploads++;
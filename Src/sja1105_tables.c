@@ -72,11 +72,99 @@ const uint8_t SJA1105_TABLE_INDEX_LUT[SJA1105_BLOCK_ID_SGMII_CONF + 1] = {
     [SJA1105_BLOCK_ID_SGMII_CONF]                   = 24,
 };
 
+/* Maximum number of entries in each table, used to size the dirty bitmaps. Parameter tables are treated as a single entry */
+const uint16_t SJA1105_TABLE_MAX_ENTRIES_LUT[SJA1105_BLOCK_ID_SGMII_CONF + 1] = {
+    [SJA1105_BLOCK_ID_SCHEDULE]                     = 1024,
+    [SJA1105_BLOCK_ID_SCHEDULE_ENTRY_POINTS]        = 2048,
+    [SJA1105_BLOCK_ID_VL_LOOKUP]                    = 1024,
+    [SJA1105_BLOCK_ID_VL_POLICING]                  = 1024,
+    [SJA1105_BLOCK_ID_VL_FORWARDING]                = 1024,
+    [SJA1105_BLOCK_ID_L2_ADDR_LOOKUP]               = SJA1105_L2ADDR_LU_NUM_ENTRIES,
+    [SJA1105_BLOCK_ID_L2_POLICING]                  = SJA1105_NUM_POLICERS,
+    [SJA1105_BLOCK_ID_VLAN_LOOKUP]                  = 4096, /* Indexed by VLAN ID rather than position */
+    [SJA1105_BLOCK_ID_L2_FORWARDING]                = SJA1105_STATIC_CONF_L2_FORWARDING_NUM_ENTRIES,
+    [SJA1105_BLOCK_ID_MAC_CONF]                     = SJA1105_NUM_PORTS,
+    [SJA1105_BLOCK_ID_SCHEDULE_PARAMS]              = 1,
+    [SJA1105_BLOCK_ID_SCHEDULE_ENTRY_POINTS_PARAMS] = 1,
+    [SJA1105_BLOCK_ID_VL_FORWARDING_PARAMS]         = 1,
+    [SJA1105_BLOCK_ID_L2_LOOKUP_PARAMS]             = 1,
+    [SJA1105_BLOCK_ID_L2_FORWARDING_PARAMS]         = 1,
+    [SJA1105_BLOCK_ID_CLK_SYNC_PARAMS]              = 1,
+    [SJA1105_BLOCK_ID_AVB_PARAMS]                   = 1,
+    [SJA1105_BLOCK_ID_GENERAL_PARAMS]               = 1,
+    [SJA1105_BLOCK_ID_RETAGGING]                    = 32,
+    [SJA1105_BLOCK_ID_CBS]                          = 16,
+    [SJA1105_BLOCK_ID_XMII_MODE]                    = 1,
+    [SJA1105_BLOCK_ID_CGU]                          = 1,
+    [SJA1105_BLOCK_ID_RGU]                          = 1,
+    [SJA1105_BLOCK_ID_ACU]                          = 1,
+    [SJA1105_BLOCK_ID_SGMII_CONF]                   = 1,
+};
+
+/* Number of uint32_t in each entry, 0 for tables whose size isn't checked */
+const uint8_t SJA1105_TABLE_ENTRY_SIZE_LUT[SJA1105_BLOCK_ID_SGMII_CONF + 1] = {
+    [SJA1105_BLOCK_ID_SCHEDULE]                     = 2,
+    [SJA1105_BLOCK_ID_SCHEDULE_ENTRY_POINTS]        = 1,
+    [SJA1105_BLOCK_ID_VL_LOOKUP]                    = 3,
+    [SJA1105_BLOCK_ID_VL_POLICING]                  = 2,
+    [SJA1105_BLOCK_ID_VL_FORWARDING]                = 1,
+    [SJA1105_BLOCK_ID_L2_ADDR_LOOKUP]               = SJA1105_L2ADDR_LU_ENTRY_SIZE,
+    [SJA1105_BLOCK_ID_L2_POLICING]                  = SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE,
+    [SJA1105_BLOCK_ID_VLAN_LOOKUP]                  = SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE,
+    [SJA1105_BLOCK_ID_L2_FORWARDING]                = SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE,
+    [SJA1105_BLOCK_ID_MAC_CONF]                     = SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE,
+    [SJA1105_BLOCK_ID_SCHEDULE_PARAMS]              = 3,
+    [SJA1105_BLOCK_ID_SCHEDULE_ENTRY_POINTS_PARAMS] = 1,
+    [SJA1105_BLOCK_ID_VL_FORWARDING_PARAMS]         = SJA1105_STATIC_CONF_VL_FORWARDING_PARAMS_SIZE,
+    [SJA1105_BLOCK_ID_L2_LOOKUP_PARAMS]             = SJA1105_STATIC_CONF_L2_LOOKUP_PARAMS_SIZE,
+    [SJA1105_BLOCK_ID_L2_FORWARDING_PARAMS]         = SJA1105_STATIC_CONF_L2_FORWARDING_PARAMS_SIZE,
+    [SJA1105_BLOCK_ID_CLK_SYNC_PARAMS]              = 0,
+    [SJA1105_BLOCK_ID_AVB_PARAMS]                   = 4,
+    [SJA1105_BLOCK_ID_GENERAL_PARAMS]               = SJA1105_STATIC_CONF_GENERAL_PARAMS_SIZE,
+    [SJA1105_BLOCK_ID_RETAGGING]                    = SJA1105_STATIC_CONF_RETAGGING_ENTRY_SIZE,
+    [SJA1105_BLOCK_ID_CBS]                          = SJA1105_STATIC_CONF_CBS_ENTRY_SIZE,
+    [SJA1105_BLOCK_ID_XMII_MODE]                    = SJA1105_STATIC_CONF_XMII_MODE_SIZE,
+    [SJA1105_BLOCK_ID_CGU]                          = 0,
+    [SJA1105_BLOCK_ID_RGU]                          = 0,
+    [SJA1105_BLOCK_ID_ACU]                          = 0,
+    [SJA1105_BLOCK_ID_SGMII_CONF]                   = 0,
+};
+
+/* Memories of the RAM parity error registers holding each table, see SJA1105_RAM_PARITY_MEMORIES(). The memories not listed
+ * here hold frames and queues, or parameters that are only set by the static configuration
+ */
+const uint64_t SJA1105_RAM_PARITY_MEMORY_LUT[SJA1105_BLOCK_ID_SGMII_CONF + 1] = {
+    [SJA1105_BLOCK_ID_SCHEDULE]              = (uint64_t) 1 << 0,
+    [SJA1105_BLOCK_ID_SCHEDULE_ENTRY_POINTS] = (uint64_t) 1 << 1,
+    [SJA1105_BLOCK_ID_VL_LOOKUP]             = (uint64_t) 1 << 2,
+    [SJA1105_BLOCK_ID_VL_POLICING]           = (uint64_t) 1 << 3,
+    [SJA1105_BLOCK_ID_VL_FORWARDING]         = (uint64_t) 1 << 4,
+    [SJA1105_BLOCK_ID_L2_ADDR_LOOKUP]        = (uint64_t) 1 << 5,
+    [SJA1105_BLOCK_ID_L2_POLICING]           = (uint64_t) 1 << 6,
+    [SJA1105_BLOCK_ID_VLAN_LOOKUP]           = (uint64_t) 1 << 7,
+    [SJA1105_BLOCK_ID_L2_FORWARDING]         = (uint64_t) 1 << 8,
+    [SJA1105_BLOCK_ID_MAC_CONF]              = (uint64_t) 1 << 9,
+    [SJA1105_BLOCK_ID_RETAGGING]             = (uint64_t) 1 << 10,
+    [SJA1105_BLOCK_ID_CBS]                   = (uint64_t) 1 << 11,
+};
+
+
+/* Read a field of up to 32 bits starting at bit low of a table entry, which may straddle two words */
+uint32_t SJA1105_TableGetField(const uint32_t *data, uint_fast16_t low, uint_fast8_t width) {
+
+    uint32_t value = data[low / 32] >> (low % 32);
+
+    if (((low % 32) + width) > 32) value |= data[(low / 32) + 1] << (32 - (low % 32));
+
+    return (width < 32) ? (value & (((uint32_t) 1 << width) - 1)) : value;
+}
+
 
 /* This function checks table data. Note it does not check CRCs */
 sja1105_status_t SJA1105_CheckTable(sja1105_handle_t *dev, sja1105_block_id_t id, const uint32_t *table_data, uint32_t size) {
 
-    sja1105_status_t status = SJA1105_OK;
+    sja1105_status_t status     = SJA1105_OK;
+    uint8_t          entry_size = SJA1105_GET_TABLE_ENTRY_SIZE(id);
 
     const sja1105_table_t table = {
         .id   = &id,
@@ -84,6 +172,13 @@ sja1105_status_t SJA1105_CheckTable(sja1105_handle_t *dev, sja1105_block_id_t id
         .data = (uint32_t *) table_data, /* Discard const :( */
     };
 
+    /* Check the table is a whole number of entries and not too big */
+    if (entry_size != 0) {
+        if ((size % entry_size) != 0) status = SJA1105_STATIC_CONF_ERROR;
+        if ((size / entry_size) > SJA1105_GET_TABLE_MAX_ENTRIES(id)) status = SJA1105_STATIC_CONF_ERROR;
+        if (status != SJA1105_OK) return status;
+    }
+
     switch (id) {
 
         case SJA1105_BLOCK_ID_MAC_CONF: {
@@ -101,6 +196,32 @@ sja1105_status_t SJA1105_CheckTable(sja1105_handle_t *dev, sja1105_block_id_t id
             break;
         }
 
+        case SJA1105_BLOCK_ID_L2_POLICING: {
+            status = SJA1105_L2PolicingTableCheck(dev, &table);
+            break;
+        }
+
+        case SJA1105_BLOCK_ID_L2_LOOKUP_PARAMS: {
+            status = SJA1105_L2LookupParamsTableCheck(dev, &table);
+            break;
+        }
+
+        case SJA1105_BLOCK_ID_RETAGGING: {
+            status = SJA1105_RetaggingTableCheck(dev, &table);
+            break;
+        }
+
+        case SJA1105_BLOCK_ID_CBS: {
+            status = SJA1105_CBSTableCheck(dev, &table);
+            break;
+        }
+
+        /* Every port and priority has an entry */
+        case SJA1105_BLOCK_ID_L2_FORWARDING: {
+            if (size != SJA1105_STATIC_CONF_L2_FORWARDING_SIZE) status = SJA1105_STATIC_CONF_ERROR;
+            break;
+        }
+
         default:
             status = SJA1105_OK;
             break;
@@ -119,12 +240,24 @@ sja1105_status_t SJA1105_MACConfTableCheck(sja1105_handle_t *dev, const sja1105_
     if (*table->size != (SJA1105_NUM_PORTS * SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE)) status = SJA1105_STATIC_CONF_ERROR;
     if (status != SJA1105_OK) return status;
 
-    /* Check each port's speed */
+    /* Check each port's speed. The MAC of an SGMII port may already be set to 1G since the PCS handles lower speeds */
     for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
         status = SJA1105_MACConfTableGetSpeed(table, port_num, &speed);
         if (status != SJA1105_OK) return status;
+        if ((dev->config->ports[port_num].interface == SJA1105_INTERFACE_SGMII) && (speed == SJA1105_SPEED_1G)) continue;
         if (speed != dev->config->ports[port_num].speed) status = SJA1105_STATIC_CONF_ERROR;
     }
+    if (status != SJA1105_OK) return status;
+
+    /* Each enabled queue must have a base address no higher than its top address */
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        const uint32_t *entry = table->data + SJA1105_STATIC_CONF_MAC_CONF_BASE(port_num);
+        for (uint_fast8_t i = 0; i < SJA1105_NUM_PRIORITIES; i++) {
+            if (!SJA1105_TableGetField(entry, SJA1105_STATIC_CONF_MAC_CONF_QUEUE_ENABLED(i), 1)) continue;
+            if (SJA1105_TableGetField(entry, SJA1105_STATIC_CONF_MAC_CONF_QUEUE_BASE(i), SJA1105_STATIC_CONF_MAC_CONF_QUEUE_WIDTH) > SJA1105_TableGetField(entry, SJA1105_STATIC_CONF_MAC_CONF_QUEUE_TOP(i), SJA1105_STATIC_CONF_MAC_CONF_QUEUE_WIDTH)) status = SJA1105_STATIC_CONF_ERROR;
+            if (status != SJA1105_OK) return status;
+        }
+    }
 
     return status;
 }
@@ -164,7 +297,7 @@ sja1105_status_t SJA1105_MACConfTableSetIngress(sja1105_table_t *table, uint8_t
         table->data[index] &= ~SJA1105_STATIC_CONF_MAC_CONF_INGRESS_MASK;
     }
 
-    table->data_crc_valid = false;
+    SJA1105_TableMarkDirty(table, port_num);
 
     return status;
 }
@@ -204,7 +337,7 @@ sja1105_status_t SJA1105_MACConfTableSetEgress(sja1105_table_t *table, uint8_t p
         table->data[index] &= ~SJA1105_STATIC_CONF_MAC_CONF_EGRESS_MASK;
     }
 
-    table->data_crc_valid = false;
+    SJA1105_TableMarkDirty(table, port_num);
 
     return status;
 }
@@ -244,7 +377,7 @@ sja1105_status_t SJA1105_MACConfTableSetDynLearn(sja1105_table_t *table, uint8_t
         table->data[index] &= ~SJA1105_STATIC_CONF_MAC_CONF_DYN_LEARN_MASK;
     }
 
-    table->data_crc_valid = false;
+    SJA1105_TableMarkDirty(table, port_num);
 
     return status;
 }
@@ -282,7 +415,7 @@ sja1105_status_t SJA1105_MACConfTableSetSpeed(sja1105_table_t *table, uint8_t po
     table->data[index] &= ~SJA1105_STATIC_CONF_MAC_CONF_SPEED_MASK;
     table->data[index] |= ((uint32_t) speed << SJA1105_STATIC_CONF_MAC_CONF_SPEED_SHIFT) & SJA1105_STATIC_CONF_MAC_CONF_SPEED_MASK;
 
-    table->data_crc_valid = false;
+    SJA1105_TableMarkDirty(table, port_num);
 
     return status;
 }
@@ -318,10 +451,8 @@ sja1105_status_t SJA1105_ResetMACConfTable(sja1105_handle_t *dev, bool write) {
 
     /* Write the configs if required */
     if (write) {
-        for (uint_fast8_t i = 0; i < SJA1105_NUM_PORTS; i++) {
-            status = SJA1105_MACConfTableWrite(dev, i);
-            if (status != SJA1105_OK) return status;
-        }
+        status = SJA1105_MACConfTableWriteMultiple(dev, (1 << SJA1105_NUM_PORTS) - 1);
+        if (status != SJA1105_OK) return status;
     }
 
     return status;
@@ -330,44 +461,40 @@ sja1105_status_t SJA1105_ResetMACConfTable(sja1105_handle_t *dev, bool write) {
 
 sja1105_status_t SJA1105_MACConfTableWrite(sja1105_handle_t *dev, uint8_t port_num) {
 
-    sja1105_status_t status   = SJA1105_OK;
-    uint32_t         reg_data = 0;
-    uint8_t          index    = SJA1105_STATIC_CONF_MAC_CONF_WORD(port_num, 0);
-    bool             error    = false;
-
-    /* Wait for VALID to be 0.
-     *
-     * Note: The VALID bit should be write only, but the documentation mentions "On read [of ERRORS] it has meaning at times when VALID is found reset".
-     *       How can VALID be found reset if it cannot be read? Write only bits return 0 on read so there is no harm in polling until it is 0.
-     */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_MAC_CONF_REG_0, SJA1105_DYN_CONF_VALID, false);
-    if (status != SJA1105_OK) return status;
+    sja1105_status_t status = SJA1105_OK;
+    uint16_t         index  = port_num;
 
-    /* Parameter and bounds checking */
+    /* Parameter checking */
     _Static_assert(SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE == (SJA1105_DYN_CONF_MAC_CONF_REG_8 - SJA1105_DYN_CONF_MAC_CONF_REG_1 + 1));
-    if ((index + SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE) > *dev->tables.mac_configuration.size) status = SJA1105_PARAMETER_ERROR;
+    if (port_num >= SJA1105_NUM_PORTS) status = SJA1105_PARAMETER_ERROR;
     if (status != SJA1105_OK) return status;
 
-    /* Write the table */
-    status = SJA1105_WriteRegister(dev, SJA1105_DYN_CONF_MAC_CONF_REG_1, dev->tables.mac_configuration.data + index, SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE);
+    /* Write and apply the entry, then check ERRORS */
+    status = SJA1105_DynTableWriteEntries(dev, SJA1105_BLOCK_ID_MAC_CONF, &index, 1);
     if (status != SJA1105_OK) return status;
 
-    /* Apply the table */
-    reg_data  = 0;
-    reg_data |= SJA1105_DYN_CONF_VALID;
-    reg_data |= SJA1105_DYN_CONF_RDWRSET; /* Operation is a write */
-    reg_data |= ((uint32_t) port_num << SJA1105_DYN_CONF_MAC_CONF_PORTID_SHIFT) & SJA1105_DYN_CONF_MAC_CONF_PORTID_MASK;
-    status    = SJA1105_WriteRegister(dev, SJA1105_DYN_CONF_MAC_CONF_REG_0, &reg_data, 1);
-    if (status != SJA1105_OK) return status;
+    return status;
+}
 
-    /* Wait for VALID to be 0 then check ERRORS, TODO: there is a wasted access here */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_MAC_CONF_REG_0, SJA1105_DYN_CONF_VALID, false);
-    if (status != SJA1105_OK) return status;
-    status = SJA1105_ReadFlag(dev, SJA1105_DYN_CONF_MAC_CONF_REG_0, SJA1105_DYN_CONF_ERRORS, &error);
+
+/* Write the MAC configuration entries of every port in port_mask back-to-back */
+sja1105_status_t SJA1105_MACConfTableWriteMultiple(sja1105_handle_t *dev, uint8_t port_mask) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint16_t         indices[SJA1105_NUM_PORTS];
+    uint32_t         count = 0;
+
+    /* Parameter checking */
+    if (port_mask >= (1 << SJA1105_NUM_PORTS)) status = SJA1105_PARAMETER_ERROR;
     if (status != SJA1105_OK) return status;
 
-    /* If ERRORS is set then the configuration is invalid and was not applied */
-    if (error) status = SJA1105_DYNAMIC_RECONFIG_ERROR;
+    /* Find the entries */
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        if (port_mask & (1 << port_num)) indices[count++] = port_num;
+    }
+
+    /* Write and apply the entries, checking ERRORS for each */
+    status = SJA1105_DynTableWriteEntries(dev, SJA1105_BLOCK_ID_MAC_CONF, indices, count);
     if (status != SJA1105_OK) return status;
 
     return status;
@@ -376,38 +503,21 @@ sja1105_status_t SJA1105_MACConfTableWrite(sja1105_handle_t *dev, uint8_t port_n
 
 sja1105_status_t SJA1105_MACConfTableRead(sja1105_handle_t *dev, uint8_t port_num) {
 
-    sja1105_status_t status   = SJA1105_OK;
-    uint32_t         reg_data = 0;
-    uint8_t          index    = SJA1105_STATIC_CONF_MAC_CONF_WORD(port_num, 0);
-
-    /* Wait for VALID to be 0.
-     *
-     * Note: The VALID bit should be write only, but the documentation mentions "On read [of ERRORS] it has meaning at times when VALID is found reset".
-     *       How can VALID be found reset if it cannot be read? Write only bits return 0 on read so there is no harm in polling until it is 0.
-     */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_MAC_CONF_REG_0, SJA1105_DYN_CONF_VALID, false);
-    if (status != SJA1105_OK) return status;
+    sja1105_status_t status = SJA1105_OK;
+    uint8_t          index  = SJA1105_STATIC_CONF_MAC_CONF_WORD(port_num, 0);
 
     /* Parameter and bounds checking */
     _Static_assert(SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE == (SJA1105_DYN_CONF_MAC_CONF_REG_8 - SJA1105_DYN_CONF_MAC_CONF_REG_1 + 1));
     if ((index + SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE) > *dev->tables.mac_configuration.size) status = SJA1105_PARAMETER_ERROR;
     if (status != SJA1105_OK) return status;
 
-    /* Setup for a read */
-    reg_data  = 0;
-    reg_data |= SJA1105_DYN_CONF_VALID;
-    reg_data &= ~SJA1105_DYN_CONF_RDWRSET; /* Operation is a read */
-    reg_data |= ((uint32_t) port_num << SJA1105_DYN_CONF_MAC_CONF_PORTID_SHIFT) & SJA1105_DYN_CONF_MAC_CONF_PORTID_MASK;
-    status    = SJA1105_WriteRegister(dev, SJA1105_DYN_CONF_MAC_CONF_REG_0, &reg_data, 1);
+    /* Read the entry into the table */
+    status = SJA1105_DynConfRead(dev, &SJA1105_DYN_CONF_MAC_CONF_DESC, ((uint32_t) port_num << SJA1105_DYN_CONF_MAC_CONF_PORTID_SHIFT) & SJA1105_DYN_CONF_MAC_CONF_PORTID_MASK, NULL, dev->tables.mac_configuration.data + index);
     if (status != SJA1105_OK) return status;
 
-    /* Wait for VALID to be 0 */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_MAC_CONF_REG_0, SJA1105_DYN_CONF_VALID, false);
-    if (status != SJA1105_OK) return status;
-
-    /* Read the table */
-    status = SJA1105_ReadRegister(dev, SJA1105_DYN_CONF_MAC_CONF_REG_1, dev->tables.mac_configuration.data + index, SJA1105_STATIC_CONF_MAC_CONF_ENTRY_SIZE);
-    if (status != SJA1105_OK) return status;
+    /* The shadow table now matches the device, but its CRC may have changed */
+    SJA1105_TableMarkClean(&dev->tables.mac_configuration, port_num);
+    dev->tables.mac_configuration.data_crc_valid = false;
 
     return status;
 }
@@ -536,37 +646,859 @@ sja1105_status_t SJA1105_xMIIModeTableCheck(sja1105_handle_t *dev, const sja1105
 }
 
 
-sja1105_status_t SJA1105_L2ForwardingTableRead(sja1105_handle_t *dev, uint8_t index) {
+sja1105_status_t SJA1105_L2PolicingTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table) {
 
-    sja1105_status_t status   = SJA1105_OK;
-    uint32_t         reg_data = 0;
-    uint8_t          offset   = index * SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE;
+    sja1105_status_t status      = SJA1105_OK;
+    uint32_t         num_entries = *table->size / SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE;
+    uint8_t          sharindx;
 
-    /* Wait for VALID to be 0 */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_L2_FORWARDING_REG_0, SJA1105_DYN_CONF_VALID, false);
+    (void) dev;
+
+    /* At least one policer is required */
+    if (num_entries == 0) status = SJA1105_STATIC_CONF_ERROR;
     if (status != SJA1105_OK) return status;
 
+    /* Each entry's shared policer must exist */
+    for (uint_fast8_t i = 0; i < num_entries; i++) {
+        sharindx = (table->data[(i * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE) + 1] & SJA1105_STATIC_CONF_L2_POLICING_SHARINDX_MASK) >> SJA1105_STATIC_CONF_L2_POLICING_SHARINDX_SHIFT;
+        if (sharindx >= num_entries) status = SJA1105_STATIC_CONF_ERROR;
+        if (status != SJA1105_OK) return status;
+    }
+
+    return status;
+}
+
+
+sja1105_status_t SJA1105_L2LookupParamsTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    (void) dev;
+
+    /* Check the size is correct */
+    if (*table->size != SJA1105_STATIC_CONF_L2_LOOKUP_PARAMS_SIZE) status = SJA1105_STATIC_CONF_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* No port can be allowed more addresses than the L2 address lookup table holds */
+    for (uint_fast8_t port_num = 0; port_num < SJA1105_NUM_PORTS; port_num++) {
+        if (SJA1105_TableGetField(table->data, SJA1105_STATIC_CONF_L2_LOOKUP_PARAMS_MAXADDRP(port_num), SJA1105_STATIC_CONF_L2_LOOKUP_PARAMS_MAXADDRP_WIDTH) > SJA1105_L2ADDR_LU_NUM_ENTRIES) status = SJA1105_STATIC_CONF_ERROR;
+        if (status != SJA1105_OK) return status;
+    }
+
+    return status;
+}
+
+
+sja1105_status_t SJA1105_RetaggingTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table) {
+
+    sja1105_status_t status = SJA1105_OK;
+    const uint32_t  *entry;
+
+    (void) dev;
+
+    /* Each rule must match at least one ingress and one egress port, and must have a destination if it overrides them */
+    for (uint32_t i = 0; i < *table->size; i += SJA1105_STATIC_CONF_RETAGGING_ENTRY_SIZE) {
+        entry = table->data + i;
+        if (SJA1105_TableGetField(entry, SJA1105_STATIC_CONF_RETAGGING_EGR_PORT, SJA1105_NUM_PORTS) == 0) status = SJA1105_STATIC_CONF_ERROR;
+        if (SJA1105_TableGetField(entry, SJA1105_STATIC_CONF_RETAGGING_INGR_PORT, SJA1105_NUM_PORTS) == 0) status = SJA1105_STATIC_CONF_ERROR;
+        if (SJA1105_TableGetField(entry, SJA1105_STATIC_CONF_RETAGGING_USE_DEST_PORTS, 1) && (SJA1105_TableGetField(entry, SJA1105_STATIC_CONF_RETAGGING_DESTPORTS, SJA1105_NUM_PORTS) == 0)) status = SJA1105_STATIC_CONF_ERROR;
+        if (status != SJA1105_OK) return status;
+    }
+
+    return status;
+}
+
+
+sja1105_status_t SJA1105_CBSTableCheck(sja1105_handle_t *dev, const sja1105_table_t *table) {
+
+    sja1105_status_t status = SJA1105_OK;
+    const uint32_t  *entry;
+
+    (void) dev;
+
+    /* Each shaper must belong to a port and priority that exist */
+    for (uint32_t i = 0; i < *table->size; i += SJA1105_STATIC_CONF_CBS_ENTRY_SIZE) {
+        entry = table->data + i;
+        if (SJA1105_TableGetField(entry, SJA1105_STATIC_CONF_CBS_PORT, SJA1105_STATIC_CONF_CBS_FIELD_WIDTH) >= SJA1105_NUM_PORTS) status = SJA1105_STATIC_CONF_ERROR;
+        if (SJA1105_TableGetField(entry, SJA1105_STATIC_CONF_CBS_PRIO, SJA1105_STATIC_CONF_CBS_FIELD_WIDTH) >= SJA1105_NUM_PRIORITIES) status = SJA1105_STATIC_CONF_ERROR;
+        if (status != SJA1105_OK) return status;
+    }
+
+    return status;
+}
+
+
+sja1105_status_t SJA1105_L2ForwardingTableRead(sja1105_handle_t *dev, uint8_t index) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint8_t          offset = index * SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE;
+
     /* Parameter checking */
     _Static_assert(SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE == (SJA1105_DYN_CONF_L2_FORWARDING_REG_2 - SJA1105_DYN_CONF_L2_FORWARDING_REG_1 + 1));
     if (index >= SJA1105_STATIC_CONF_L2_FORWARDING_NUM_ENTRIES) status = SJA1105_PARAMETER_ERROR;
     if (offset >= SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE * SJA1105_STATIC_CONF_L2_FORWARDING_NUM_ENTRIES) status = SJA1105_PARAMETER_ERROR;
     if (status != SJA1105_OK) return status;
 
-    /* Setup for a read */
-    reg_data  = 0;
-    reg_data |= SJA1105_DYN_CONF_VALID;
-    reg_data &= ~SJA1105_DYN_CONF_RDWRSET; /* Operation is a read */
-    reg_data |= ((uint32_t) index << SJA1105_DYN_CONF_L2_FORWARDING_INDEX_SHIFT) & SJA1105_DYN_CONF_L2_FORWARDING_INDEX_MASK;
-    status    = SJA1105_WriteRegister(dev, SJA1105_DYN_CONF_L2_FORWARDING_REG_0, &reg_data, 1);
+    /* Read the entry into the table */
+    status = SJA1105_DynConfRead(dev, &SJA1105_DYN_CONF_L2_FORWARDING_DESC, ((uint32_t) index << SJA1105_DYN_CONF_L2_FORWARDING_INDEX_SHIFT) & SJA1105_DYN_CONF_L2_FORWARDING_INDEX_MASK, NULL, dev->tables.l2_forwarding.data + offset);
     if (status != SJA1105_OK) return status;
 
-    /* Wait for VALID to be 0 */
-    status = SJA1105_PollFlag(dev, SJA1105_DYN_CONF_L2_FORWARDING_REG_0, SJA1105_DYN_CONF_VALID, false);
+    /* The shadow table now matches the device, but its CRC may have changed */
+    SJA1105_TableMarkClean(&dev->tables.l2_forwarding, index);
+    dev->tables.l2_forwarding.data_crc_valid = false;
+
+    return status;
+}
+
+
+/* Convert a port's L2 forwarding table entry to its forwarding settings */
+void SJA1105_L2ForwardingEntryUnpack(const uint32_t entry[SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE], sja1105_l2_forwarding_t *forwarding) {
+
+    /* VLAN_PMAP for priority 2 crosses the word boundary so combine the words */
+    uint64_t data = ((uint64_t) entry[1] << 32) | entry[0];
+
+    forwarding->reach_port = (entry[1] & SJA1105_STATIC_CONF_L2_FORWARDING_REACH_PORT_MASK) >> SJA1105_STATIC_CONF_L2_FORWARDING_REACH_PORT_SHIFT;
+    forwarding->bc_domain  = (entry[1] & SJA1105_STATIC_CONF_L2_FORWARDING_BC_DOMAIN_MASK) >> SJA1105_STATIC_CONF_L2_FORWARDING_BC_DOMAIN_SHIFT;
+    forwarding->fl_domain  = (entry[1] & SJA1105_STATIC_CONF_L2_FORWARDING_FL_DOMAIN_MASK) >> SJA1105_STATIC_CONF_L2_FORWARDING_FL_DOMAIN_SHIFT;
+    for (uint_fast8_t prio = 0; prio < SJA1105_NUM_PRIORITIES; prio++) {
+        forwarding->vlan_pmap[prio] = (data >> SJA1105_STATIC_CONF_L2_FORWARDING_VLAN_PMAP_SHIFT(prio)) & SJA1105_STATIC_CONF_L2_FORWARDING_VLAN_PMAP_MASK;
+    }
+}
+
+
+/* Convert a port's forwarding settings into its L2 forwarding table entry. Only the fields are replaced, the other bits of
+ * the entry are kept
+ */
+void SJA1105_L2ForwardingEntryPack(const sja1105_l2_forwarding_t *forwarding, uint32_t entry[SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE]) {
+
+    uint64_t data = ((uint64_t) entry[1] << 32) | entry[0];
+
+    for (uint_fast8_t prio = 0; prio < SJA1105_NUM_PRIORITIES; prio++) {
+        data &= ~((uint64_t) SJA1105_STATIC_CONF_L2_FORWARDING_VLAN_PMAP_MASK << SJA1105_STATIC_CONF_L2_FORWARDING_VLAN_PMAP_SHIFT(prio));
+        data |= (uint64_t) (forwarding->vlan_pmap[prio] & SJA1105_STATIC_CONF_L2_FORWARDING_VLAN_PMAP_MASK) << SJA1105_STATIC_CONF_L2_FORWARDING_VLAN_PMAP_SHIFT(prio);
+    }
+
+    entry[0]  = (uint32_t) data;
+    entry[1]  = (uint32_t) (data >> 32);
+    entry[1] &= ~(SJA1105_STATIC_CONF_L2_FORWARDING_REACH_PORT_MASK | SJA1105_STATIC_CONF_L2_FORWARDING_BC_DOMAIN_MASK | SJA1105_STATIC_CONF_L2_FORWARDING_FL_DOMAIN_MASK);
+    entry[1] |= ((uint32_t) forwarding->reach_port << SJA1105_STATIC_CONF_L2_FORWARDING_REACH_PORT_SHIFT) & SJA1105_STATIC_CONF_L2_FORWARDING_REACH_PORT_MASK;
+    entry[1] |= ((uint32_t) forwarding->bc_domain << SJA1105_STATIC_CONF_L2_FORWARDING_BC_DOMAIN_SHIFT) & SJA1105_STATIC_CONF_L2_FORWARDING_BC_DOMAIN_MASK;
+    entry[1] |= ((uint32_t) forwarding->fl_domain << SJA1105_STATIC_CONF_L2_FORWARDING_FL_DOMAIN_SHIFT) & SJA1105_STATIC_CONF_L2_FORWARDING_FL_DOMAIN_MASK;
+}
+
+
+/* Convert an L2 policing table entry to a policer */
+void SJA1105_PolicerEntryUnpack(const uint32_t entry[SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE], sja1105_policer_t *policer) {
+
+    uint32_t rate;
+
+    rate  = (entry[0] & SJA1105_STATIC_CONF_L2_POLICING_RATE_LOW_MASK) >> SJA1105_STATIC_CONF_L2_POLICING_RATE_LOW_SHIFT;
+    rate |= ((entry[1] & SJA1105_STATIC_CONF_L2_POLICING_RATE_HIGH_MASK) >> SJA1105_STATIC_CONF_L2_POLICING_RATE_HIGH_SHIFT) << 6;
+
+    policer->rate_bps = rate * SJA1105_L2_POLICING_RATE_UNIT_BPS;
+    policer->burst    = (entry[1] & SJA1105_STATIC_CONF_L2_POLICING_SMAX_MASK) >> SJA1105_STATIC_CONF_L2_POLICING_SMAX_SHIFT;
+    policer->max_len  = (entry[0] & SJA1105_STATIC_CONF_L2_POLICING_MAXLEN_MASK) >> SJA1105_STATIC_CONF_L2_POLICING_MAXLEN_SHIFT;
+    policer->sharindx = (entry[1] & SJA1105_STATIC_CONF_L2_POLICING_SHARINDX_MASK) >> SJA1105_STATIC_CONF_L2_POLICING_SHARINDX_SHIFT;
+}
+
+
+/* Convert a policer to an L2 policing table entry. The partition is not part of the policer so it is kept */
+void SJA1105_PolicerEntryPack(const sja1105_policer_t *policer, uint32_t entry[SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE]) {
+
+    uint32_t rate = policer->rate_bps / SJA1105_L2_POLICING_RATE_UNIT_BPS;
+
+    entry[0] &= SJA1105_STATIC_CONF_L2_POLICING_PARTITION_MASK;
+    entry[0] |= ((uint32_t) policer->max_len << SJA1105_STATIC_CONF_L2_POLICING_MAXLEN_SHIFT) & SJA1105_STATIC_CONF_L2_POLICING_MAXLEN_MASK;
+    entry[0] |= (rate << SJA1105_STATIC_CONF_L2_POLICING_RATE_LOW_SHIFT) & SJA1105_STATIC_CONF_L2_POLICING_RATE_LOW_MASK;
+    entry[1]  = ((rate >> 6) << SJA1105_STATIC_CONF_L2_POLICING_RATE_HIGH_SHIFT) & SJA1105_STATIC_CONF_L2_POLICING_RATE_HIGH_MASK;
+    entry[1] |= ((uint32_t) policer->burst << SJA1105_STATIC_CONF_L2_POLICING_SMAX_SHIFT) & SJA1105_STATIC_CONF_L2_POLICING_SMAX_MASK;
+    entry[1] |= ((uint32_t) policer->sharindx << SJA1105_STATIC_CONF_L2_POLICING_SHARINDX_SHIFT) & SJA1105_STATIC_CONF_L2_POLICING_SHARINDX_MASK;
+}
+
+
+/* Convert a VLAN to a VLAN lookup table entry */
+void SJA1105_VLANEntryPack(const sja1105_vlan_t *vlan, uint32_t entry[SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE]) {
+
+    entry[0]  = ((uint32_t) vlan->vid << SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_LOW_SHIFT) & SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_LOW_MASK;
+    entry[1]  = ((uint32_t) (vlan->vid >> 5) << SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_HIGH_SHIFT) & SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_HIGH_MASK;
+    entry[1] |= ((uint32_t) vlan->tag_port << SJA1105_STATIC_CONF_VLAN_LOOKUP_TAG_PORT_SHIFT) & SJA1105_STATIC_CONF_VLAN_LOOKUP_TAG_PORT_MASK;
+    entry[1] |= ((uint32_t) vlan->vlan_bc << SJA1105_STATIC_CONF_VLAN_LOOKUP_VLAN_BC_SHIFT) & SJA1105_STATIC_CONF_VLAN_LOOKUP_VLAN_BC_MASK;
+    entry[1] |= ((uint32_t) vlan->vmemb_port << SJA1105_STATIC_CONF_VLAN_LOOKUP_VMEMB_PORT_SHIFT) & SJA1105_STATIC_CONF_VLAN_LOOKUP_VMEMB_PORT_MASK;
+    entry[1] |= ((uint32_t) vlan->vegr_mirr << SJA1105_STATIC_CONF_VLAN_LOOKUP_VEGR_MIRR_SHIFT) & SJA1105_STATIC_CONF_VLAN_LOOKUP_VEGR_MIRR_MASK;
+    entry[1] |= ((uint32_t) vlan->ving_mirr << SJA1105_STATIC_CONF_VLAN_LOOKUP_VING_MIRR_SHIFT) & SJA1105_STATIC_CONF_VLAN_LOOKUP_VING_MIRR_MASK;
+}
+
+
+/* Convert a VLAN lookup table entry to a VLAN */
+void SJA1105_VLANEntryUnpack(const uint32_t entry[SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE], sja1105_vlan_t *vlan) {
+
+    vlan->vid        = SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_GET(entry);
+    vlan->tag_port   = (entry[1] & SJA1105_STATIC_CONF_VLAN_LOOKUP_TAG_PORT_MASK) >> SJA1105_STATIC_CONF_VLAN_LOOKUP_TAG_PORT_SHIFT;
+    vlan->vlan_bc    = (entry[1] & SJA1105_STATIC_CONF_VLAN_LOOKUP_VLAN_BC_MASK) >> SJA1105_STATIC_CONF_VLAN_LOOKUP_VLAN_BC_SHIFT;
+    vlan->vmemb_port = (entry[1] & SJA1105_STATIC_CONF_VLAN_LOOKUP_VMEMB_PORT_MASK) >> SJA1105_STATIC_CONF_VLAN_LOOKUP_VMEMB_PORT_SHIFT;
+    vlan->vegr_mirr  = (entry[1] & SJA1105_STATIC_CONF_VLAN_LOOKUP_VEGR_MIRR_MASK) >> SJA1105_STATIC_CONF_VLAN_LOOKUP_VEGR_MIRR_SHIFT;
+    vlan->ving_mirr  = (entry[1] & SJA1105_STATIC_CONF_VLAN_LOOKUP_VING_MIRR_MASK) >> SJA1105_STATIC_CONF_VLAN_LOOKUP_VING_MIRR_SHIFT;
+}
+
+
+/* Allocate and fill the VLAN ID presence bitmap and index for the VLAN lookup table. Must be called after the table is loaded */
+sja1105_status_t SJA1105_VLANIndexBuild(sja1105_handle_t *dev) {
+
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_table_t *table  = &dev->tables.vlan_lookup;
+    uint32_t         num_entries;
+    uint16_t         vid;
+
+    /* Check the index isn't already allocated */
+    if ((dev->tables.vlan_present != NULL) || (dev->tables.vlan_index != NULL)) status = SJA1105_DYNAMIC_MEMORY_ERROR;
     if (status != SJA1105_OK) return status;
 
-    /* Read the table */
-    status = SJA1105_ReadRegister(dev, SJA1105_DYN_CONF_L2_FORWARDING_REG_1, dev->tables.l2_forwarding.data + offset, SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE);
+    /* Check the table size */
+    num_entries = *table->size / SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE;
+    if ((*table->size % SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE) != 0) status = SJA1105_STATIC_CONF_ERROR;
+    if (num_entries > SJA1105_NUM_VLAN_IDS) status = SJA1105_STATIC_CONF_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Allocate the memory */
+    status = dev->callbacks->callback_allocate(dev, &dev->tables.vlan_present, SJA1105_VLAN_PRESENT_SIZE);
+    if (status != SJA1105_OK) return status;
+    status = dev->callbacks->callback_allocate(dev, (uint32_t **) &dev->tables.vlan_index, SJA1105_VLAN_INDEX_SIZE);
     if (status != SJA1105_OK) return status;
+    memset(dev->tables.vlan_present, 0, SJA1105_VLAN_PRESENT_SIZE * sizeof(uint32_t));
+
+    /* Index every entry, each VLAN ID may only appear once */
+    for (uint32_t i = 0; i < num_entries; i++) {
+        vid = SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_GET(table->data + (i * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE));
+        if (SJA1105_VLANIsPresent(dev, vid)) status = SJA1105_STATIC_CONF_ERROR;
+        if (status != SJA1105_OK) return status;
+        dev->tables.vlan_present[vid / 32] |= (uint32_t) 1 << (vid % 32);
+        dev->tables.vlan_index[vid]         = i;
+    }
+
+    return status;
+}
+
+
+/* Free the VLAN ID presence bitmap and index */
+sja1105_status_t SJA1105_VLANIndexFree(sja1105_handle_t *dev) {
+
+    sja1105_status_t status = SJA1105_OK;
+
+    if (dev->tables.vlan_present != NULL) {
+        status = dev->callbacks->callback_free(dev, dev->tables.vlan_present);
+        if (status != SJA1105_OK) return status;
+        dev->tables.vlan_present = NULL;
+    }
+    if (dev->tables.vlan_index != NULL) {
+        status = dev->callbacks->callback_free(dev, (uint32_t *) dev->tables.vlan_index);
+        if (status != SJA1105_OK) return status;
+        dev->tables.vlan_index = NULL;
+    }
+
+    return status;
+}
+
+
+/* Check whether the VLAN lookup table has an entry for a VLAN ID */
+bool SJA1105_VLANIsPresent(const sja1105_handle_t *dev, uint16_t vid) {
+
+    if ((dev->tables.vlan_present == NULL) || (vid >= SJA1105_NUM_VLAN_IDS)) return false;
+    return (dev->tables.vlan_present[vid / 32] & ((uint32_t) 1 << (vid % 32))) != 0;
+}
+
+
+/* Get a VLAN's entry in the VLAN lookup table, or NULL if there isn't one */
+uint32_t *SJA1105_VLANGetEntry(sja1105_handle_t *dev, uint16_t vid) {
+
+    if (!SJA1105_VLANIsPresent(dev, vid)) return NULL;
+    return dev->tables.vlan_lookup.data + (dev->tables.vlan_index[vid] * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE);
+}
+
+
+/* Make sure there is space to add num_new entries to the VLAN lookup table. Normally the headroom allocated when the table
+ * was loaded is enough. If it isn't then the table is moved to an allocation with at least double the capacity, so the
+ * cost of moving it is amortised over many insertions and the memory pool sees few allocations.
+ */
+sja1105_status_t SJA1105_VLANTableReserve(sja1105_handle_t *dev, uint16_t num_new) {
+
+    sja1105_status_t status   = SJA1105_OK;
+    sja1105_table_t *table    = &dev->tables.vlan_lookup;
+    uint32_t         required = *table->size + (num_new * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE);
+    uint32_t         capacity = 0;
+    uint32_t        *data     = NULL;
+
+    /* Check there is enough space */
+    if (required > (SJA1105_NUM_VLAN_IDS * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE)) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* The entries are about to change so they can't stay in the static config */
+    status = SJA1105_TableMakeWritable(dev, table);
+    if (status != SJA1105_OK) return status;
+    if (required <= table->capacity) return status;
+
+    /* Move the entries to a larger allocation */
+    capacity = CONSTRAIN(table->capacity * 2, required, SJA1105_NUM_VLAN_IDS * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE);
+    status   = dev->callbacks->callback_allocate(dev, &data, capacity);
+    if (status != SJA1105_OK) return status;
+    memcpy(data, table->data, *table->size * sizeof(uint32_t));
+    status = dev->callbacks->callback_free(dev, table->data);
+    if (status != SJA1105_OK) return status;
+    table->data     = data;
+    table->capacity = capacity;
+
+    return status;
+}
+
+
+/* Add an entry to the end of the VLAN lookup table. Space must have been reserved with SJA1105_VLANTableReserve() */
+sja1105_status_t SJA1105_VLANTableAppend(sja1105_handle_t *dev, const uint32_t entry[SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE]) {
+
+    sja1105_status_t status   = SJA1105_OK;
+    sja1105_table_t *table    = &dev->tables.vlan_lookup;
+    uint16_t         position = *table->size / SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE;
+    uint16_t         vid      = SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_GET(entry);
+
+    /* Parameter checking */
+    if (SJA1105_VLANIsPresent(dev, vid)) status = SJA1105_PARAMETER_ERROR;
+    if ((*table->size + SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE) > table->capacity) status = SJA1105_MEMORY_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Add the entry and index it */
+    status = SJA1105_TableSetSize(dev, table, *table->size + SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE);
+    if (status != SJA1105_OK) return status;
+    memcpy(table->data + (position * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE), entry, SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE * sizeof(uint32_t));
+    dev->tables.vlan_present[vid / 32] |= (uint32_t) 1 << (vid % 32);
+    dev->tables.vlan_index[vid]         = position;
+
+    return status;
+}
+
+
+/* Remove a VLAN's entry from the VLAN lookup table by moving the last entry into its place */
+sja1105_status_t SJA1105_VLANTableRemove(sja1105_handle_t *dev, uint16_t vid) {
+
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_table_t *table  = &dev->tables.vlan_lookup;
+    uint32_t        *entry  = NULL;
+    uint32_t        *last   = NULL;
+
+    /* The entries are about to change so they can't stay in the static config */
+    status = SJA1105_TableMakeWritable(dev, table);
+    if (status != SJA1105_OK) return status;
+    entry = SJA1105_VLANGetEntry(dev, vid);
+    last  = table->data + *table->size - SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE;
+
+    /* Parameter checking */
+    if (entry == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Fill the gap with the last entry */
+    if (entry != last) {
+        memcpy(entry, last, SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE * sizeof(uint32_t));
+        dev->tables.vlan_index[SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_GET(entry)] = dev->tables.vlan_index[vid];
+    }
+
+    /* Remove the entry and its index */
+    status = SJA1105_TableSetSize(dev, table, *table->size - SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE);
+    if (status != SJA1105_OK) return status;
+    dev->tables.vlan_present[vid / 32] &= ~((uint32_t) 1 << (vid % 32));
+    SJA1105_TableMarkClean(table, vid);
+
+    return status;
+}
+
+
+/* Check whether entries of a table can be written with SJA1105_DynTableWriteEntries(). Must match the tables supported
+ * by SJA1105_DynTableGetEntry().
+ */
+bool SJA1105_DynTableIsWritable(uint8_t block_id) {
+
+    switch (block_id) {
+        case SJA1105_BLOCK_ID_MAC_CONF:
+        case SJA1105_BLOCK_ID_L2_FORWARDING:
+        case SJA1105_BLOCK_ID_VLAN_LOOKUP:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+/* Find an entry of a dynamically reconfigurable table in the shadow tables, along with the interface and command used to write it */
+sja1105_status_t SJA1105_DynTableGetEntry(sja1105_handle_t *dev, uint8_t block_id, uint16_t index, const sja1105_dyn_conf_t **dyn_conf, uint32_t **entry, uint32_t *command) {
+
+    sja1105_status_t status = SJA1105_OK;
+    sja1105_table_t *table;
+    uint32_t         offset;
+
+    switch (block_id) {
+
+        case SJA1105_BLOCK_ID_MAC_CONF:
+            table     = &dev->tables.mac_configuration;
+            offset    = SJA1105_STATIC_CONF_MAC_CONF_WORD(index, 0);
+            *dyn_conf = &SJA1105_DYN_CONF_MAC_CONF_DESC;
+            *command  = ((uint32_t) index << SJA1105_DYN_CONF_MAC_CONF_PORTID_SHIFT) & SJA1105_DYN_CONF_MAC_CONF_PORTID_MASK;
+            if (index >= SJA1105_NUM_PORTS) status = SJA1105_PARAMETER_ERROR;
+            break;
+
+        case SJA1105_BLOCK_ID_L2_FORWARDING:
+            table     = &dev->tables.l2_forwarding;
+            offset    = index * SJA1105_STATIC_CONF_L2_FORWARDING_ENTRY_SIZE;
+            *dyn_conf = &SJA1105_DYN_CONF_L2_FORWARDING_DESC;
+            *command  = ((uint32_t) index << SJA1105_DYN_CONF_L2_FORWARDING_INDEX_SHIFT) & SJA1105_DYN_CONF_L2_FORWARDING_INDEX_MASK;
+            if (index >= SJA1105_STATIC_CONF_L2_FORWARDING_NUM_ENTRIES) status = SJA1105_PARAMETER_ERROR;
+            break;
+
+        /* The VLAN lookup table is indexed by VLAN ID, the command sets VALIDENT so the entry is added if it doesn't exist */
+        case SJA1105_BLOCK_ID_VLAN_LOOKUP:
+            table     = &dev->tables.vlan_lookup;
+            offset    = SJA1105_VLANIsPresent(dev, index) ? dev->tables.vlan_index[index] * SJA1105_STATIC_CONF_VLAN_LOOKUP_ENTRY_SIZE : 0;
+            *dyn_conf = &SJA1105_DYN_CONF_VLAN_LOOKUP_DESC;
+            *command  = SJA1105_DYN_CONF_VLAN_LOOKUP_VALIDENT;
+            if (!SJA1105_VLANIsPresent(dev, index)) status = SJA1105_PARAMETER_ERROR;
+            break;
+
+        default:
+            status = SJA1105_NOT_IMPLEMENTED_ERROR;
+            break;
+    }
+    if (status != SJA1105_OK) return status;
+
+    /* Bounds checking */
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) return status;
+    if ((offset + (*dyn_conf)->entry_size) > *table->size) status = SJA1105_PARAMETER_ERROR;
+    if ((*dyn_conf)->entry_size > SJA1105_TRANSACTION_MAX_ENTRY_SIZE) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    *entry = table->data + offset;
+
+    return status;
+}
+
+
+/* Tables that can be read with SJA1105_DynTableReadRange(), in the order they are read */
+const uint8_t SJA1105_DYN_TABLE_READ_ORDER[SJA1105_DYN_TABLE_NUM_READABLE] = {
+    SJA1105_BLOCK_ID_MAC_CONF,
+    SJA1105_BLOCK_ID_L2_FORWARDING,
+    SJA1105_BLOCK_ID_GENERAL_PARAMS,
+    SJA1105_BLOCK_ID_L2_LOOKUP_PARAMS,
+    SJA1105_BLOCK_ID_RETAGGING,
+    SJA1105_BLOCK_ID_VLAN_LOOKUP,
+    SJA1105_BLOCK_ID_L2_ADDR_LOOKUP,
+};
+
+
+/* Read count entries of a dynamically reconfigurable table starting at the entry first, several entries at a time. Entries
+ * past the end of the table are ignored and the number of entries in the table is returned in num_entries (if not NULL).
+ * Entries with changes that haven't been written yet are skipped. The L2 lookup and VLAN lookup tables are read using the
+ * shadow entry as the key.
+ *
+ * If scrub is false the shadow table is updated from the device, except for entries the device reports don't exist. If scrub
+ * is true the shadow table is left unchanged and entries that differ from the device are counted in events.scrub_mismatches,
+ * then written back to the device if the table is dynamically writable.
+ */
+sja1105_status_t SJA1105_DynTableReadRange(sja1105_handle_t *dev, uint8_t block_id, uint32_t first, uint32_t count, bool scrub, uint32_t *num_entries) {
+
+    sja1105_status_t          status      = SJA1105_OK;
+    sja1105_table_t          *table       = SJA1105_GetTable(dev, block_id);
+    const sja1105_dyn_conf_t *dyn_conf    = NULL;
+    uint32_t                  command     = 0;     /* Flags set in every read command */
+    uint32_t                  index_shift = 0;     /* Position of the index in the command register */
+    uint32_t                  index_mask  = 0;     /* 0 if the table is read using a key or only has one entry */
+    uint32_t                  valident    = 0;     /* Flag cleared by the device if the entry doesn't exist, 0 if the table doesn't have one */
+    bool                      keyed       = false; /* The entry registers must contain the shadow entry before the read command */
+    uint32_t                  buffer[SJA1105_DYN_CONF_READ_BATCH][SJA1105_DYN_CONF_MAX_ENTRY_SIZE];
+    uint32_t                  commands[SJA1105_DYN_CONF_READ_BATCH];
+    const uint32_t           *keys[SJA1105_DYN_CONF_READ_BATCH];
+    uint32_t                 *entries[SJA1105_DYN_CONF_READ_BATCH];
+    uint32_t                  results[SJA1105_DYN_CONF_READ_BATCH];
+    uint32_t                 *shadows[SJA1105_DYN_CONF_READ_BATCH];
+    uint16_t                  indices[SJA1105_DYN_CONF_READ_BATCH];
+    uint16_t                  repairs[SJA1105_DYN_CONF_READ_BATCH];
+    uint32_t                  num_repairs = 0;
+    uint32_t                  batch       = 0;
+    uint32_t                  size        = 0;
+    uint32_t                  last;
+    uint32_t                 *shadow;
+    uint16_t                  index;
+    bool                      exists;
+
+    /* Parameter checking */
+    if (table == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    switch (block_id) {
+
+        case SJA1105_BLOCK_ID_L2_ADDR_LOOKUP:
+            dyn_conf = &SJA1105_DYN_CONF_L2_LUT_DESC;
+            command  = ((uint32_t) SJA1105_L2_LUT_HOSTCMD_READ << SJA1105_L2_LUT_HOSTCMD_SHIFT) & SJA1105_L2_LUT_HOSTCMD_MASK;
+            valident = SJA1105_DYN_CONF_L2_LUT_VALIDENT;
+            keyed    = true;
+            break;
+
+        case SJA1105_BLOCK_ID_VLAN_LOOKUP:
+            dyn_conf = &SJA1105_DYN_CONF_VLAN_LOOKUP_DESC;
+            valident = SJA1105_DYN_CONF_VLAN_LOOKUP_VALIDENT;
+            keyed    = true;
+            break;
+
+        case SJA1105_BLOCK_ID_L2_FORWARDING:
+            dyn_conf    = &SJA1105_DYN_CONF_L2_FORWARDING_DESC;
+            index_shift = SJA1105_DYN_CONF_L2_FORWARDING_INDEX_SHIFT;
+            index_mask  = SJA1105_DYN_CONF_L2_FORWARDING_INDEX_MASK;
+            break;
+
+        case SJA1105_BLOCK_ID_MAC_CONF:
+            dyn_conf    = &SJA1105_DYN_CONF_MAC_CONF_DESC;
+            index_shift = SJA1105_DYN_CONF_MAC_CONF_PORTID_SHIFT;
+            index_mask  = SJA1105_DYN_CONF_MAC_CONF_PORTID_MASK;
+            break;
+
+        case SJA1105_BLOCK_ID_L2_LOOKUP_PARAMS:
+            dyn_conf = &SJA1105_DYN_CONF_L2_LOOKUP_PARAMS_DESC;
+            break;
+
+        case SJA1105_BLOCK_ID_GENERAL_PARAMS:
+            dyn_conf = &SJA1105_DYN_CONF_GENERAL_PARAMS_DESC;
+            break;
+
+        case SJA1105_BLOCK_ID_RETAGGING:
+            dyn_conf    = &SJA1105_DYN_CONF_RETAGGING_DESC;
+            index_shift = SJA1105_DYN_CONF_RETAGGING_INDEX_SHIFT;
+            index_mask  = SJA1105_DYN_CONF_RETAGGING_INDEX_MASK;
+            valident    = SJA1105_DYN_CONF_RETAGGING_VALIDENT;
+            break;
+
+        default:
+            status = SJA1105_NOT_IMPLEMENTED_ERROR;
+            break;
+    }
+    if (status != SJA1105_OK) return status;
+
+    /* Find the range of entries to read */
+    if (table->in_use) size = *table->size / dyn_conf->entry_size;
+    if (num_entries != NULL) *num_entries = size;
+    if (first >= size) return status;
+    last = first + CONSTRAIN(count, 0, size - first);
+
+    for (uint32_t i = first; i < last; i++) {
+
+        /* The VLAN lookup table's dirty bitmap is indexed by VLAN ID */
+        shadow = table->data + (i * dyn_conf->entry_size);
+        index  = (block_id == SJA1105_BLOCK_ID_VLAN_LOOKUP) ? SJA1105_STATIC_CONF_VLAN_LOOKUP_VLANID_GET(shadow) : i;
+
+        /* Add the entry to the batch, unless it has changes that haven't been written yet */
+        if (!SJA1105_TableIsDirty(table, index)) {
+            commands[batch] = command | (((uint32_t) i << index_shift) & index_mask);
+            keys[batch]     = shadow;
+            entries[batch]  = buffer[batch];
+            shadows[batch]  = shadow;
+            indices[batch]  = index;
+            batch++;
+        }
+
+        /* Read the batch once it is full or there are no more entries */
+        if ((batch < SJA1105_DYN_CONF_READ_BATCH) && ((i + 1) < last)) continue;
+        status = SJA1105_DynConfReadMultiple(dev, dyn_conf, commands, keyed ? keys : NULL, entries, results, batch);
+        if (status != SJA1105_OK) return status;
+
+        for (uint_fast8_t j = 0; j < batch; j++) {
+            exists = (valident == 0) || (results[j] & valident);
+
+            /* Compare the entry against the shadow table and queue it to be repaired if possible */
+            if (scrub) {
+                dev->events.scrub_entries++;
+                if (exists && (memcmp(shadows[j], buffer[j], dyn_conf->entry_size * sizeof(uint32_t)) == 0)) continue;
+                dev->events.scrub_mismatches++;
+                if (SJA1105_DynTableIsWritable(block_id)) repairs[num_repairs++] = indices[j];
+            }
+
+            /* Copy the entry into the shadow table, which now matches the device but its CRC may have changed */
+            else if (exists) {
+                if (memcmp(shadows[j], buffer[j], dyn_conf->entry_size * sizeof(uint32_t)) == 0) continue;
+
+                /* A table still in the static config is only copied to RAM once an entry actually differs */
+                if (table->borrowed) {
+                    shadow = table->data;
+                    status = SJA1105_TableMakeWritable(dev, table);
+                    if (status != SJA1105_OK) return status;
+                    for (uint_fast8_t k = j; k < batch; k++) shadows[k] = table->data + (shadows[k] - shadow);
+                }
+                memcpy(shadows[j], buffer[j], dyn_conf->entry_size * sizeof(uint32_t));
+                SJA1105_TableMarkClean(table, indices[j]);
+                table->data_crc_valid = false;
+            }
+        }
+        batch = 0;
+
+        /* Write the shadow table entries that differ back to the device */
+        if (num_repairs > 0) {
+            status = SJA1105_DynTableWriteEntries(dev, block_id, repairs, num_repairs);
+            if (status != SJA1105_OK) return status;
+            dev->events.scrub_repairs += num_repairs;
+            num_repairs                = 0;
+        }
+    }
+
+    return status;
+}
+
+
+/* Find an entry that can be part of a transaction in the shadow tables. These are the entries of the dynamically
+ * reconfigurable tables, plus the L2 policing table which is applied by uploading the static config when committed.
+ */
+sja1105_status_t SJA1105_TransactionGetEntry(sja1105_handle_t *dev, uint8_t block_id, uint16_t index, uint32_t **entry, uint8_t *entry_size) {
+
+    sja1105_status_t          status = SJA1105_OK;
+    sja1105_table_t          *table  = &dev->tables.l2_policing;
+    const sja1105_dyn_conf_t *dyn_conf;
+    uint32_t                  command;
+
+    if (block_id != SJA1105_BLOCK_ID_L2_POLICING) {
+        status = SJA1105_DynTableGetEntry(dev, block_id, index, &dyn_conf, entry, &command);
+        if (status != SJA1105_OK) return status;
+        *entry_size = dyn_conf->entry_size;
+        return status;
+    }
+
+    /* Bounds checking */
+    if (!table->in_use) status = SJA1105_MISSING_TABLE_ERROR;
+    if (status != SJA1105_OK) return status;
+    if (((uint32_t) (index + 1) * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE) > *table->size) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    *entry      = table->data + (index * SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE);
+    *entry_size = SJA1105_STATIC_CONF_L2_POLICING_ENTRY_SIZE;
+
+    return status;
+}
+
+
+/* Save the original contents of an entry before it is changed so it can be restored if the transaction fails. Must be
+ * called before modifying any entry supported by SJA1105_TransactionGetEntry(), and before adding or removing a VLAN.
+ * Does nothing if there is no transaction open or if the entry has already been saved.
+ */
+sja1105_status_t SJA1105_TransactionJournal(sja1105_handle_t *dev, uint8_t block_id, uint16_t index) {
+
+    sja1105_status_t       status      = SJA1105_OK;
+    sja1105_transaction_t *transaction = &dev->transaction;
+    sja1105_vlan_t         vlan        = {.vid = index};
+    uint32_t              *entry;
+    uint8_t                entry_size;
+    bool                   present;
+
+    /* Nothing to do */
+    if (!transaction->open) return status;
+
+    /* Check if the entry has already been saved */
+    for (uint_fast8_t i = 0; i < transaction->num_entries; i++) {
+        if ((transaction->block_ids[i] == block_id) && (transaction->indices[i] == index)) return status;
+    }
+
+    /* Check there is space */
+    if (transaction->num_entries >= SJA1105_TRANSACTION_MAX_ENTRIES) status = SJA1105_MEMORY_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* A VLAN being added has no entry yet, so only its VLAN ID is saved (which is all that is needed to remove it again) */
+    present = (block_id != SJA1105_BLOCK_ID_VLAN_LOOKUP) || SJA1105_VLANIsPresent(dev, index);
+    if (present) {
+        status = SJA1105_TransactionGetEntry(dev, block_id, index, &entry, &entry_size);
+        if (status != SJA1105_OK) return status;
+        if (entry_size > SJA1105_TRANSACTION_MAX_ENTRY_SIZE) status = SJA1105_PARAMETER_ERROR;
+        if (status != SJA1105_OK) return status;
+        memcpy(transaction->backups[transaction->num_entries], entry, entry_size * sizeof(uint32_t));
+    } else {
+        SJA1105_VLANEntryPack(&vlan, transaction->backups[transaction->num_entries]);
+    }
+
+    /* Save the entry */
+    transaction->block_ids[transaction->num_entries] = block_id;
+    transaction->indices[transaction->num_entries]   = index;
+    transaction->present[transaction->num_entries]   = present;
+    transaction->dirty[transaction->num_entries]     = present && SJA1105_TableIsDirty(SJA1105_GetTable(dev, block_id), index);
+    transaction->num_entries++;
+
+    return status;
+}
+
+
+/* Restore every entry saved by the transaction to its original contents, adding back removed VLANs and removing added ones.
+ * Only the shadow tables are changed.
+ */
+void SJA1105_TransactionRestore(sja1105_handle_t *dev) {
+
+    sja1105_transaction_t *transaction = &dev->transaction;
+    sja1105_table_t       *table;
+    uint32_t              *entry;
+    uint8_t                entry_size;
+    bool                   present;
+
+    /* Remove the added VLANs first so there is space to add back the removed ones. The VLAN lookup table's capacity never
+     * shrinks, so this can't run out of space
+     */
+    for (uint_fast8_t i = 0; i < transaction->num_entries; i++) {
+        if (transaction->block_ids[i] != SJA1105_BLOCK_ID_VLAN_LOOKUP) continue;
+        present = SJA1105_VLANIsPresent(dev, transaction->indices[i]);
+        if (!transaction->present[i] && present) SJA1105_VLANTableRemove(dev, transaction->indices[i]);
+    }
+    for (uint_fast8_t i = 0; i < transaction->num_entries; i++) {
+        if (transaction->block_ids[i] != SJA1105_BLOCK_ID_VLAN_LOOKUP) continue;
+        present = SJA1105_VLANIsPresent(dev, transaction->indices[i]);
+        if (transaction->present[i] && !present) SJA1105_VLANTableAppend(dev, transaction->backups[i]);
+    }
+
+    for (uint_fast8_t i = 0; i < transaction->num_entries; i++) {
+        if (!transaction->present[i]) continue;
+
+        /* Entries were found when they were saved so this can't fail */
+        if (SJA1105_TransactionGetEntry(dev, transaction->block_ids[i], transaction->indices[i], &entry, &entry_size) != SJA1105_OK) continue;
+        memcpy(entry, transaction->backups[i], entry_size * sizeof(uint32_t));
+
+        /* Restore the dirty state. The table has changed so its CRC must be recalculated */
+        table = SJA1105_GetTable(dev, transaction->block_ids[i]);
+        if (transaction->dirty[i]) {
+            SJA1105_TableMarkDirty(table, transaction->indices[i]);
+        } else {
+            SJA1105_TableMarkClean(table, transaction->indices[i]);
+            table->data_crc_valid = false;
+        }
+    }
+}
+
+
+/* Get a table from its block ID, returns NULL if the ID is invalid */
+sja1105_table_t *SJA1105_GetTable(sja1105_handle_t *dev, uint8_t block_id) {
+
+    uint8_t table_index = SJA1105_GET_TABLE_INDEX(block_id);
+
+    if (table_index >= SJA1105_NUM_TABLES) return NULL;
+
+    return &dev->tables.by_index[table_index];
+}
+
+
+/* Change the number of words in a table's data. The header CRC is updated immediately and the data CRC is invalidated */
+sja1105_status_t SJA1105_TableSetSize(sja1105_handle_t *dev, sja1105_table_t *table, uint32_t size) {
+
+    sja1105_status_t status = SJA1105_OK;
+    uint32_t         header[SJA1105_STATIC_CONF_BLOCK_HEADER];
+    uint32_t         header_crc;
+
+    /* Calculate the CRC of the new header */
+    header[SJA1105_STATIC_CONF_BLOCK_ID_OFFSET]   = ((uint32_t) *table->id) << SJA1105_STATIC_CONF_BLOCK_ID_SHIFT;
+    header[SJA1105_STATIC_CONF_BLOCK_SIZE_OFFSET] = (size << SJA1105_STATIC_CONF_BLOCK_SIZE_SHIFT) & SJA1105_STATIC_CONF_BLOCK_SIZE_MASK;
+    status                                        = dev->callbacks->callback_crc_reset(dev);
+    if (status != SJA1105_OK) return status;
+    status = dev->callbacks->callback_crc_accumulate(dev, header, SJA1105_STATIC_CONF_BLOCK_HEADER, &header_crc);
+    if (status != SJA1105_OK) return status;
+
+    *table->size                 = size;
+    *table->header_crc           = header_crc;
+    table->data_crc_valid        = false;
+    dev->tables.global_crc_valid = false;
+
+    return status;
+}
+
+
+/* Mark an entry as changed. This also invalidates the table's CRC */
+void SJA1105_TableMarkDirty(sja1105_table_t *table, uint16_t index) {
+
+    table->data_crc_valid = false;
+
+    if ((table->dirty == NULL) || (index >= SJA1105_GET_TABLE_MAX_ENTRIES(*table->id))) return;
+    table->dirty[index / 32] |= (uint32_t) 1 << (index % 32);
+}
+
+
+/* Write a single word of a fixed length table, only invalidating the CRC if the word actually changed */
+void SJA1105_TableSetWord(sja1105_table_t *table, uint32_t index, uint32_t value) {
+
+    if (!table->in_use || (index >= *table->size) || (table->data[index] == value)) return;
+    table->data[index]    = value;
+    table->data_crc_valid = false;
+}
+
+
+/* Mark an entry as the same as on the device */
+void SJA1105_TableMarkClean(sja1105_table_t *table, uint16_t index) {
+
+    if ((table->dirty == NULL) || (index >= SJA1105_GET_TABLE_MAX_ENTRIES(*table->id))) return;
+    table->dirty[index / 32] &= ~((uint32_t) 1 << (index % 32));
+}
+
+
+/* Mark every entry in a table as the same as on the device, e.g. after uploading the static config */
+void SJA1105_TableMarkAllClean(sja1105_table_t *table) {
+
+    if (table->dirty == NULL) return;
+    memset(table->dirty, 0, SJA1105_DIRTY_BITMAP_SIZE(*table->id) * sizeof(uint32_t));
+}
+
+
+bool SJA1105_TableIsDirty(const sja1105_table_t *table, uint16_t index) {
+
+    if ((table->dirty == NULL) || (index >= SJA1105_GET_TABLE_MAX_ENTRIES(*table->id))) return false;
+    return (table->dirty[index / 32] & ((uint32_t) 1 << (index % 32))) != 0;
+}
+
+
+/* Count the number of changed entries in a table */
+uint32_t SJA1105_TableCountDirtyEntries(const sja1105_table_t *table) {
+
+    uint32_t count = 0;
+
+    if (table->dirty == NULL) return count;
+    for (uint_fast16_t i = 0; i < (uint_fast16_t) SJA1105_DIRTY_BITMAP_SIZE(*table->id); i++) {
+        count += __builtin_popcount(table->dirty[i]);
+    }
+
+    return count;
+}
+
+
+/* Write entries of a dynamically reconfigurable table from the shadow tables to the device back-to-back, then mark them
+ * as clean. Writes are deferred while a transaction is open.
+ */
+sja1105_status_t SJA1105_DynTableWriteEntries(sja1105_handle_t *dev, uint8_t block_id, const uint16_t *indices, uint32_t count) {
+
+    sja1105_status_t          status = SJA1105_OK;
+    sja1105_table_t          *table  = SJA1105_GetTable(dev, block_id);
+    const sja1105_dyn_conf_t *dyn_conf;
+    uint32_t                  commands[SJA1105_DYN_CONF_MAX_BATCH];
+    const uint32_t           *entries[SJA1105_DYN_CONF_MAX_BATCH];
+    uint32_t                 *entry;
+    uint32_t                  batch;
+
+    /* Parameter checking */
+    if (table == NULL) status = SJA1105_PARAMETER_ERROR;
+    if (status != SJA1105_OK) return status;
+
+    /* Writes are deferred until the transaction is committed */
+    if (dev->transaction.open) return status;
+
+    /* Write the entries in batches */
+    for (uint32_t i = 0; i < count; i += batch) {
+        batch = CONSTRAIN(count - i, 0, SJA1105_DYN_CONF_MAX_BATCH);
+
+        /* Find the entries and create the commands */
+        for (uint_fast8_t j = 0; j < batch; j++) {
+            status = SJA1105_DynTableGetEntry(dev, block_id, indices[i + j], &dyn_conf, &entry, &commands[j]);
+            if (status != SJA1105_OK) return status;
+            entries[j] = entry;
+        }
+
+        /* Write and apply the entries, checking ERRORS for each */
+        status = SJA1105_DynConfWriteMultiple(dev, dyn_conf, commands, entries, batch);
+        if (status != SJA1105_OK) return status;
+
+        /* The device now matches the shadow table */
+        for (uint_fast8_t j = 0; j < batch; j++) {
+            SJA1105_TableMarkClean(table, indices[i + j]);
+        }
+    }
 
     return status;
 }